@@ -0,0 +1,163 @@
+#include <stdio.h>
+
+#include <GL/glew.h>
+
+#include <glfw3.h>
+
+#ifdef HAVE_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#include "context.hpp"
+
+static GLFWwindow* contextWindow = NULL;
+
+#ifdef HAVE_EGL
+static EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+static EGLContext eglContext = EGL_NO_CONTEXT;
+
+static void destroyEglContext()
+{
+    if (eglContext != EGL_NO_CONTEXT)
+    {
+        eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(eglDisplay, eglContext);
+        eglContext = EGL_NO_CONTEXT;
+    }
+    if (eglDisplay != EGL_NO_DISPLAY)
+    {
+        eglTerminate(eglDisplay);
+        eglDisplay = EGL_NO_DISPLAY;
+    }
+}
+
+static bool createEglContext()
+{
+    // the surfaceless platform of Mesa needs no display server, the default display may need one
+#ifdef EGL_PLATFORM_SURFACELESS_MESA
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay != NULL)
+    {
+        eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    }
+#endif
+    if (eglDisplay == EGL_NO_DISPLAY)
+    {
+        eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    EGLint major, minor;
+    if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, &major, &minor))
+    {
+        eglDisplay = EGL_NO_DISPLAY;
+        return false;
+    }
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        destroyEglContext();
+        return false;
+    }
+
+    // no surface is ever created, any config rendering with OpenGL will do, or none if the display has none
+    const EGLint configAttribs[] = {EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+    EGLConfig config = (EGLConfig)0;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(eglDisplay, configAttribs, &config, 1, &configCount) || configCount == 0)
+    {
+        config = (EGLConfig)0; // EGL_KHR_no_config_context
+    }
+
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION_KHR, 3,
+        EGL_CONTEXT_MINOR_VERSION_KHR, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR,
+        EGL_NONE
+    };
+    eglContext = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, contextAttribs);
+    if (eglContext == EGL_NO_CONTEXT ||
+        !eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, eglContext))
+    {
+        destroyEglContext();
+        return false;
+    }
+
+    // glewInit() also initializes GLX, which fails without a display: only the GL entry points matter here
+    glewExperimental = true; // Needed for core profile
+    glewInit();
+    if (!GLEW_VERSION_3_3)
+    {
+        destroyEglContext();
+        return false;
+    }
+    glGetError(); // GLEW may leave GL_INVALID_ENUM behind
+
+    return true;
+}
+#endif
+
+static bool createGlfwContext(bool window, int width, int height, const char* title)
+{
+    if (!glfwInit())
+    {
+        return false;
+    }
+
+    glfwWindowHint(GLFW_SAMPLES, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE); // To make MacOS happy; should not be needed
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, window ? GL_TRUE : GL_FALSE);
+    GLFWwindow* glfwWindow = glfwCreateWindow(width, height, title, NULL, NULL);
+    if (glfwWindow == NULL)
+    {
+        glfwTerminate();
+        return false;
+    }
+    glfwMakeContextCurrent(glfwWindow);
+
+    glewExperimental = true; // Needed for core profile
+    if (glewInit() != GLEW_OK)
+    {
+        glfwDestroyWindow(glfwWindow);
+        glfwTerminate();
+        return false;
+    }
+
+    contextWindow = glfwWindow;
+
+    return true;
+}
+
+bool createContext(bool window, int width, int height, const char* title)
+{
+#ifdef HAVE_EGL
+    if (!window && createEglContext())
+    {
+        return true;
+    }
+#endif
+
+    return createGlfwContext(window, width, height, title);
+}
+
+GLFWwindow* getContextWindow()
+{
+    return contextWindow;
+}
+
+void destroyContext()
+{
+#ifdef HAVE_EGL
+    destroyEglContext();
+#endif
+
+    if (contextWindow != NULL)
+    {
+        glfwDestroyWindow(contextWindow);
+        glfwTerminate();
+        contextWindow = NULL;
+    }
+}
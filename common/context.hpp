@@ -0,0 +1,19 @@
+#ifndef CONTEXT_HPP
+#define CONTEXT_HPP
+
+struct GLFWwindow;
+
+// Create an OpenGL 3.3 core context, make it current and initialize GLEW.
+// Without a window, a surfaceless EGL context is tried first: it needs no display server, so the tools also
+// run in containers and on CI machines with Mesa llvmpipe. They render into their own framebuffer objects.
+// GLFW is used for a window, or for a hidden one when there is no EGL.
+// Returns false if there is no context, nothing has to be destroyed then.
+bool createContext(bool window, int width, int height, const char* title);
+
+// window of the context, NULL if it has none
+GLFWwindow* getContextWindow();
+
+// release the context of createContext()
+void destroyContext();
+
+#endif
@@ -40,6 +40,7 @@ Triangle::Triangle(Point& a, Point& b, Point& c)
   constrained_edge[0] = constrained_edge[1] = constrained_edge[2] = false;
   delaunay_edge[0] = delaunay_edge[1] = delaunay_edge[2] = false;
   interior_ = false;
+  map_index_ = -1;
 }
 
 // Update neighbor pointers
@@ -355,6 +356,29 @@ Triangle& Triangle::NeighborAcross(Point& opoint)
   return *neighbors_[2];
 }
 
+bool Triangle::CircumcicleContains(const Point& point) const
+{
+  const double adx = points_[0]->x - point.x;
+  const double ady = points_[0]->y - point.y;
+  const double bdx = points_[1]->x - point.x;
+  const double bdy = points_[1]->y - point.y;
+  const double cdx = points_[2]->x - point.x;
+  const double cdy = points_[2]->y - point.y;
+
+  const double alift = adx * adx + ady * ady;
+  const double blift = bdx * bdx + bdy * bdy;
+  const double clift = cdx * cdx + cdy * cdy;
+
+  const double det = alift * (bdx * cdy - cdx * bdy)
+                   + blift * (cdx * ady - adx * cdy)
+                   + clift * (adx * bdy - bdx * ady);
+
+  // The determinant is positive for a point inside a CCW triangle
+  const double area = (points_[0]->x - points_[2]->x) * (points_[1]->y - points_[2]->y)
+                    - (points_[0]->y - points_[2]->y) * (points_[1]->x - points_[2]->x);
+  return area > 0 ? det > 0 : det < 0;
+}
+
 void Triangle::DebugPrint()
 {
   using namespace std;
@@ -363,5 +387,27 @@ void Triangle::DebugPrint()
   cout << points_[2]->x << "," << points_[2]->y << endl;
 }
 
+std::ostream& operator <<(std::ostream& out, const Point& point)
+{
+  return out << point.x << "," << point.y;
+}
+
+bool IsDelaunay(const std::vector<Triangle*>& triangles)
+{
+  for (size_t i = 0; i < triangles.size(); i++) {
+    for (size_t j = 0; j < triangles.size(); j++) {
+      if (i == j) {
+        continue;
+      }
+      for (int k = 0; k < 3; k++) {
+        if (triangles[i]->CircumcicleContains(*triangles[j]->GetPoint(k))) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
 }
 
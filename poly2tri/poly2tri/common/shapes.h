@@ -37,6 +37,7 @@
 #include <cstddef>
 #include <assert.h>
 #include <cmath>
+#include <ostream>
 
 namespace p2t {
 
@@ -203,6 +204,9 @@ inline void IsInterior(bool b);
 
 Triangle& NeighborAcross(Point& opoint);
 
+/// Is the point strictly inside the circumcircle of this triangle?
+bool CircumcicleContains(const Point& point) const;
+
 void DebugPrint();
 
 private:
@@ -214,6 +218,10 @@ Triangle* neighbors_[3];
 
 /// Has this triangle been marked as an interior triangle?
 bool interior_;
+
+friend class SweepContext;
+/// Position in the triangle map of the sweep context, -1 if it is not in the map
+int map_index_;
 };
 
 inline bool cmp(const Point* a, const Point* b)
@@ -257,6 +265,8 @@ inline bool operator !=(const Point& a, const Point& b)
   return !(a.x == b.x) && !(a.y == b.y);
 }
 
+std::ostream& operator <<(std::ostream& out, const Point& point);
+
 /// Peform the dot product on two vectors.
 inline double Dot(const Point& a, const Point& b)
 {
@@ -318,6 +328,9 @@ inline void Triangle::IsInterior(bool b)
   interior_ = b;
 }
 
+/// Is no triangle vertex strictly inside the circumcircle of another triangle?
+bool IsDelaunay(const std::vector<Triangle*>& triangles);
+
 }
 
 #endif
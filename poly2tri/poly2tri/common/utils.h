@@ -35,6 +35,7 @@
 // Otherwise #defines like M_PI are undeclared under Visual Studio
 #define _USE_MATH_DEFINES
 
+#include <cmath>
 #include <exception>
 #include <math.h>
 
@@ -44,8 +45,355 @@ const double PI_3div4 = 3 * M_PI / 4;
 const double PI_div2 = 1.57079632679489661923;
 const double EPSILON = 1e-12;
 
+// Relative rounding error of a double operation, half an ulp of 1.0
+const double ROUNDOFF = 1.1102230246251565e-16;
+// Error bounds of the floating point filters of Orient2d and Incircle, relative to the
+// permanents of the determinants, see J. Shewchuk, "Adaptive Precision Floating-Point
+// Arithmetic and Fast Robust Geometric Predicates"
+const double ORIENT2D_BOUND = (3.0 + 16.0 * ROUNDOFF) * ROUNDOFF;
+const double INCIRCLE_BOUND = (10.0 + 96.0 * ROUNDOFF) * ROUNDOFF;
+// Error bounds of the later stages of Orient2dAdapt and Incircle2dAdapt
+const double ORIENT2D_BOUND_B = (2.0 + 12.0 * ROUNDOFF) * ROUNDOFF;
+const double ORIENT2D_BOUND_C = (9.0 + 64.0 * ROUNDOFF) * ROUNDOFF * ROUNDOFF;
+const double INCIRCLE_BOUND_B = (4.0 + 48.0 * ROUNDOFF) * ROUNDOFF;
+const double INCIRCLE_BOUND_C = (44.0 + 576.0 * ROUNDOFF) * ROUNDOFF * ROUNDOFF;
+const double RESULT_BOUND = (3.0 + 8.0 * ROUNDOFF) * ROUNDOFF;
+
 enum Orientation { CW, CCW, COLLINEAR };
 
+/// Exact arithmetic on expansions: sums of doubles, nonoverlapping and sorted by increasing
+/// magnitude, whose sign is the sign of their last component. Used when a filter fails, in
+/// fixed size arrays on the stack, see Shewchuk's paper.
+/// Needs IEEE double rounding, so neither -ffast-math nor x87 extended precision.
+
+/// x + y = a + b exactly, x = fl(a + b)
+inline void TwoSum(double a, double b, double& x, double& y)
+{
+  x = a + b;
+  double bv = x - a;
+  double av = x - bv;
+  y = (a - av) + (b - bv);
+}
+
+/// x + y = a + b exactly, x = fl(a + b), given |a| >= |b|
+inline void FastTwoSum(double a, double b, double& x, double& y)
+{
+  x = a + b;
+  y = b - (x - a);
+}
+
+/// x + y = a - b exactly, x = fl(a - b)
+inline void TwoDiff(double a, double b, double& x, double& y)
+{
+  x = a - b;
+  double bv = a - x;
+  double av = x + bv;
+  y = (a - av) + (bv - b);
+}
+
+/// Rounding error of x = fl(a - b)
+inline double TwoDiffTail(double a, double b, double x)
+{
+  double bv = a - x;
+  double av = x + bv;
+  return (a - av) + (bv - b);
+}
+
+/// x + y = a * b exactly, x = fl(a * b)
+inline void TwoProduct(double a, double b, double& x, double& y)
+{
+  x = a * b;
+  y = std::fma(a, b, -x);
+}
+
+/// x[3] + x[2] + x[1] + x[0] = (a1 + a0) - (b1 + b0) exactly
+inline void TwoTwoDiff(double a1, double a0, double b1, double b0, double x[4])
+{
+  double i, j, k;
+  TwoDiff(a0, b0, i, x[0]);
+  TwoSum(a1, i, j, k);
+  TwoDiff(k, b1, i, x[1]);
+  TwoSum(j, i, x[3], x[2]);
+}
+
+/// h = e + f, without zero components. h has room for elen + flen components
+inline int FastExpansionSum(int elen, const double* e, int flen, const double* f, double* h)
+{
+  int eindex = 0, findex = 0, hindex = 0;
+  double q, qnew, hh;
+  if ((f[0] > e[0]) == (f[0] > -e[0])) {
+    q = e[eindex++];
+  } else {
+    q = f[findex++];
+  }
+  if (eindex < elen && findex < flen) {
+    if ((f[findex] > e[eindex]) == (f[findex] > -e[eindex])) {
+      FastTwoSum(e[eindex++], q, qnew, hh);
+    } else {
+      FastTwoSum(f[findex++], q, qnew, hh);
+    }
+    q = qnew;
+    if (hh != 0.0)
+      h[hindex++] = hh;
+    while (eindex < elen && findex < flen) {
+      if ((f[findex] > e[eindex]) == (f[findex] > -e[eindex])) {
+        TwoSum(q, e[eindex++], qnew, hh);
+      } else {
+        TwoSum(q, f[findex++], qnew, hh);
+      }
+      q = qnew;
+      if (hh != 0.0)
+        h[hindex++] = hh;
+    }
+  }
+  while (eindex < elen) {
+    TwoSum(q, e[eindex++], qnew, hh);
+    q = qnew;
+    if (hh != 0.0)
+      h[hindex++] = hh;
+  }
+  while (findex < flen) {
+    TwoSum(q, f[findex++], qnew, hh);
+    q = qnew;
+    if (hh != 0.0)
+      h[hindex++] = hh;
+  }
+  if (q != 0.0 || hindex == 0)
+    h[hindex++] = q;
+  return hindex;
+}
+
+/// h = e * b, without zero components. h has room for 2 * elen components
+inline int ScaleExpansion(int elen, const double* e, double b, double* h)
+{
+  int hindex = 0;
+  double q, hh;
+  TwoProduct(e[0], b, q, hh);
+  if (hh != 0.0)
+    h[hindex++] = hh;
+  for (int i = 1; i < elen; i++) {
+    double product1, product0, sum;
+    TwoProduct(e[i], b, product1, product0);
+    TwoSum(q, product0, sum, hh);
+    if (hh != 0.0)
+      h[hindex++] = hh;
+    FastTwoSum(product1, sum, q, hh);
+    if (hh != 0.0)
+      h[hindex++] = hh;
+  }
+  if (q != 0.0 || hindex == 0)
+    h[hindex++] = q;
+  return hindex;
+}
+
+/// Approximation of an expansion
+inline double Estimate(int elen, const double* e)
+{
+  double q = e[0];
+  for (int i = 1; i < elen; i++)
+    q += e[i];
+  return q;
+}
+
+/// Orientation determinant of Orient2d when its filter fails, detsum is the permanent of the
+/// filter. Tries the determinant of the rounded differences and its first order correction
+/// before the exact value, which needs at most 16 components
+double Orient2dAdapt(const Point& pa, const Point& pb, const Point& pc, double detsum)
+{
+  double acx = pa.x - pc.x;
+  double bcx = pb.x - pc.x;
+  double acy = pa.y - pc.y;
+  double bcy = pb.y - pc.y;
+
+  double detleft, detlefttail, detright, detrighttail;
+  TwoProduct(acx, bcy, detleft, detlefttail);
+  TwoProduct(acy, bcx, detright, detrighttail);
+  double b[4];
+  TwoTwoDiff(detleft, detlefttail, detright, detrighttail, b);
+
+  double det = Estimate(4, b);
+  double errbound = ORIENT2D_BOUND_B * detsum;
+  if (det >= errbound || -det >= errbound)
+    return det;
+
+  double acxtail = TwoDiffTail(pa.x, pc.x, acx);
+  double bcxtail = TwoDiffTail(pb.x, pc.x, bcx);
+  double acytail = TwoDiffTail(pa.y, pc.y, acy);
+  double bcytail = TwoDiffTail(pb.y, pc.y, bcy);
+  if (acxtail == 0.0 && acytail == 0.0 && bcxtail == 0.0 && bcytail == 0.0)
+    return det;
+
+  errbound = ORIENT2D_BOUND_C * detsum + RESULT_BOUND * fabs(det);
+  det += (acx * bcytail + bcy * acxtail) - (acy * bcxtail + bcx * acytail);
+  if (det >= errbound || -det >= errbound)
+    return det;
+
+  double s1, s0, t1, t0, u[4];
+  double c1[8], c2[12], d[16];
+  TwoProduct(acxtail, bcy, s1, s0);
+  TwoProduct(acytail, bcx, t1, t0);
+  TwoTwoDiff(s1, s0, t1, t0, u);
+  int c1length = FastExpansionSum(4, b, 4, u, c1);
+
+  TwoProduct(acx, bcytail, s1, s0);
+  TwoProduct(acy, bcxtail, t1, t0);
+  TwoTwoDiff(s1, s0, t1, t0, u);
+  int c2length = FastExpansionSum(c1length, c1, 4, u, c2);
+
+  TwoProduct(acxtail, bcytail, s1, s0);
+  TwoProduct(acytail, bcxtail, t1, t0);
+  TwoTwoDiff(s1, s0, t1, t0, u);
+  int dlength = FastExpansionSum(c2length, c2, 4, u, d);
+
+  return d[dlength - 1];
+}
+
+/// Incircle determinant computed exactly from the coordinates, without their rounded
+/// differences: positive if pd is inside the circle through pa, pb and pc, given in CCW order,
+/// negative if it is outside, 0 if on the circle. Needs at most 384 components
+double Incircle2dExact(const Point& pa, const Point& pb, const Point& pc, const Point& pd)
+{
+  double ab[4], bc[4], cd[4], da[4], ac[4], bd[4];
+  double x1, x0, y1, y0;
+  TwoProduct(pa.x, pb.y, x1, x0);
+  TwoProduct(pb.x, pa.y, y1, y0);
+  TwoTwoDiff(x1, x0, y1, y0, ab);
+  TwoProduct(pb.x, pc.y, x1, x0);
+  TwoProduct(pc.x, pb.y, y1, y0);
+  TwoTwoDiff(x1, x0, y1, y0, bc);
+  TwoProduct(pc.x, pd.y, x1, x0);
+  TwoProduct(pd.x, pc.y, y1, y0);
+  TwoTwoDiff(x1, x0, y1, y0, cd);
+  TwoProduct(pd.x, pa.y, x1, x0);
+  TwoProduct(pa.x, pd.y, y1, y0);
+  TwoTwoDiff(x1, x0, y1, y0, da);
+  TwoProduct(pa.x, pc.y, x1, x0);
+  TwoProduct(pc.x, pa.y, y1, y0);
+  TwoTwoDiff(x1, x0, y1, y0, ac);
+  TwoProduct(pb.x, pd.y, x1, x0);
+  TwoProduct(pd.x, pb.y, y1, y0);
+  TwoTwoDiff(x1, x0, y1, y0, bd);
+
+  // Orientations of the triangles without one of the points
+  double temp8[8], abc[12], bcd[12], cda[12], dab[12];
+  int templength = FastExpansionSum(4, cd, 4, da, temp8);
+  int cdalength = FastExpansionSum(templength, temp8, 4, ac, cda);
+  templength = FastExpansionSum(4, da, 4, ab, temp8);
+  int dablength = FastExpansionSum(templength, temp8, 4, bd, dab);
+  for (int i = 0; i < 4; i++) {
+    bd[i] = -bd[i];
+    ac[i] = -ac[i];
+  }
+  templength = FastExpansionSum(4, ab, 4, bc, temp8);
+  int abclength = FastExpansionSum(templength, temp8, 4, ac, abc);
+  templength = FastExpansionSum(4, bc, 4, cd, temp8);
+  int bcdlength = FastExpansionSum(templength, temp8, 4, bd, bcd);
+
+  // Each one lifted by the squared norm of the missing point
+  double det24x[24], det24y[24], det48x[48], det48y[48];
+  double adet[96], bdet[96], cdet[96], ddet[96];
+  int xlength = ScaleExpansion(bcdlength, bcd, pa.x, det24x);
+  xlength = ScaleExpansion(xlength, det24x, pa.x, det48x);
+  int ylength = ScaleExpansion(bcdlength, bcd, pa.y, det24y);
+  ylength = ScaleExpansion(ylength, det24y, pa.y, det48y);
+  int alength = FastExpansionSum(xlength, det48x, ylength, det48y, adet);
+
+  xlength = ScaleExpansion(cdalength, cda, pb.x, det24x);
+  xlength = ScaleExpansion(xlength, det24x, -pb.x, det48x);
+  ylength = ScaleExpansion(cdalength, cda, pb.y, det24y);
+  ylength = ScaleExpansion(ylength, det24y, -pb.y, det48y);
+  int blength = FastExpansionSum(xlength, det48x, ylength, det48y, bdet);
+
+  xlength = ScaleExpansion(dablength, dab, pc.x, det24x);
+  xlength = ScaleExpansion(xlength, det24x, pc.x, det48x);
+  ylength = ScaleExpansion(dablength, dab, pc.y, det24y);
+  ylength = ScaleExpansion(ylength, det24y, pc.y, det48y);
+  int clength = FastExpansionSum(xlength, det48x, ylength, det48y, cdet);
+
+  xlength = ScaleExpansion(abclength, abc, pd.x, det24x);
+  xlength = ScaleExpansion(xlength, det24x, -pd.x, det48x);
+  ylength = ScaleExpansion(abclength, abc, pd.y, det24y);
+  ylength = ScaleExpansion(ylength, det24y, -pd.y, det48y);
+  int dlength = FastExpansionSum(xlength, det48x, ylength, det48y, ddet);
+
+  double abdet[192], cddet[192], det[384];
+  int ablength = FastExpansionSum(alength, adet, blength, bdet, abdet);
+  int cdlength = FastExpansionSum(clength, cdet, dlength, ddet, cddet);
+  int length = FastExpansionSum(ablength, abdet, cdlength, cddet, det);
+  return det[length - 1];
+}
+
+/// Incircle determinant, with the sign convention of Incircle2dExact, when the filter of
+/// Sweep::Incircle fails, permanent is the permanent of that filter. Tries the determinant of
+/// the rounded differences, at most 192 components, and its first order correction before the
+/// exact value
+double Incircle2dAdapt(const Point& pa, const Point& pb, const Point& pc, const Point& pd,
+                       double permanent)
+{
+  double adx = pa.x - pd.x;
+  double bdx = pb.x - pd.x;
+  double cdx = pc.x - pd.x;
+  double ady = pa.y - pd.y;
+  double bdy = pb.y - pd.y;
+  double cdy = pc.y - pd.y;
+
+  double x1, x0, y1, y0;
+  double bc[4], ca[4], ab[4];
+  double xbc[8], xxbc[16], ybc[8], yybc[16];
+  double adet[32], bdet[32], cdet[32], abdet[64], fin[192];
+
+  TwoProduct(bdx, cdy, x1, x0);
+  TwoProduct(cdx, bdy, y1, y0);
+  TwoTwoDiff(x1, x0, y1, y0, bc);
+  int xlength = ScaleExpansion(ScaleExpansion(4, bc, adx, xbc), xbc, adx, xxbc);
+  int ylength = ScaleExpansion(ScaleExpansion(4, bc, ady, ybc), ybc, ady, yybc);
+  int alength = FastExpansionSum(xlength, xxbc, ylength, yybc, adet);
+
+  TwoProduct(cdx, ady, x1, x0);
+  TwoProduct(adx, cdy, y1, y0);
+  TwoTwoDiff(x1, x0, y1, y0, ca);
+  xlength = ScaleExpansion(ScaleExpansion(4, ca, bdx, xbc), xbc, bdx, xxbc);
+  ylength = ScaleExpansion(ScaleExpansion(4, ca, bdy, ybc), ybc, bdy, yybc);
+  int blength = FastExpansionSum(xlength, xxbc, ylength, yybc, bdet);
+
+  TwoProduct(adx, bdy, x1, x0);
+  TwoProduct(bdx, ady, y1, y0);
+  TwoTwoDiff(x1, x0, y1, y0, ab);
+  xlength = ScaleExpansion(ScaleExpansion(4, ab, cdx, xbc), xbc, cdx, xxbc);
+  ylength = ScaleExpansion(ScaleExpansion(4, ab, cdy, ybc), ybc, cdy, yybc);
+  int clength = FastExpansionSum(xlength, xxbc, ylength, yybc, cdet);
+
+  int ablength = FastExpansionSum(alength, adet, blength, bdet, abdet);
+  int length = FastExpansionSum(ablength, abdet, clength, cdet, fin);
+
+  double det = Estimate(length, fin);
+  double errbound = INCIRCLE_BOUND_B * permanent;
+  if (det >= errbound || -det >= errbound)
+    return det;
+
+  double adxtail = TwoDiffTail(pa.x, pd.x, adx);
+  double adytail = TwoDiffTail(pa.y, pd.y, ady);
+  double bdxtail = TwoDiffTail(pb.x, pd.x, bdx);
+  double bdytail = TwoDiffTail(pb.y, pd.y, bdy);
+  double cdxtail = TwoDiffTail(pc.x, pd.x, cdx);
+  double cdytail = TwoDiffTail(pc.y, pd.y, cdy);
+  if (adxtail == 0.0 && bdxtail == 0.0 && cdxtail == 0.0 &&
+      adytail == 0.0 && bdytail == 0.0 && cdytail == 0.0)
+    return det;
+
+  errbound = INCIRCLE_BOUND_C * permanent + RESULT_BOUND * fabs(det);
+  det += ((adx * adx + ady * ady) * ((bdx * cdytail + cdy * bdxtail) - (bdy * cdxtail + cdx * bdytail)) +
+          2.0 * (adx * adxtail + ady * adytail) * (bdx * cdy - bdy * cdx)) +
+         ((bdx * bdx + bdy * bdy) * ((cdx * adytail + ady * cdxtail) - (cdy * adxtail + adx * cdytail)) +
+          2.0 * (bdx * bdxtail + bdy * bdytail) * (cdx * ady - cdy * adx)) +
+         ((cdx * cdx + cdy * cdy) * ((adx * bdytail + bdy * adxtail) - (ady * bdxtail + bdx * adytail)) +
+          2.0 * (cdx * cdxtail + cdy * cdytail) * (adx * bdy - ady * bdx));
+  if (det >= errbound || -det >= errbound)
+    return det;
+
+  return Incircle2dExact(pa, pb, pc, pd);
+}
+
 /**
  * Forumla to calculate signed area<br>
  * Positive if CCW<br>
@@ -61,7 +409,12 @@ Orientation Orient2d(Point& pa, Point& pb, Point& pc)
   double detleft = (pa.x - pc.x) * (pb.y - pc.y);
   double detright = (pa.y - pc.y) * (pb.x - pc.x);
   double val = detleft - detright;
-  if (val > -EPSILON && val < EPSILON) {
+  // The sign of val is exact unless val is within the rounding error of the products
+  double bound = ORIENT2D_BOUND * (fabs(detleft) + fabs(detright));
+  if (val <= bound && val >= -bound) {
+    val = Orient2dAdapt(pa, pb, pc, fabs(detleft) + fabs(detright));
+  }
+  if (val == 0) {
     return COLLINEAR;
   } else if (val > 0) {
     return CCW;
@@ -103,15 +456,13 @@ bool InScanArea(Point& pa, Point& pb, Point& pc, Point& pd)
 
 */
 
+/// pb is strictly right of pa->pd and pc strictly left of it
 bool InScanArea(Point& pa, Point& pb, Point& pc, Point& pd)
 {
-  double oadb = (pa.x - pb.x)*(pd.y - pb.y) - (pd.x - pb.x)*(pa.y - pb.y);
-  if (oadb >= -EPSILON) {
+  if (Orient2d(pa, pd, pb) != CW) {
     return false;
   }
-
-  double oadc = (pa.x - pc.x)*(pd.y - pc.y) - (pd.x - pc.x)*(pa.y - pc.y);
-  if (oadc <= EPSILON) {
+  if (Orient2d(pa, pd, pc) != CCW) {
     return false;
   }
   return true;
@@ -29,80 +29,95 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include "advancing_front.h"
+#include <map>
 
 namespace p2t {
 
-AdvancingFront::AdvancingFront(Node& head, Node& tail)
+struct NodeIndex {
+  std::multimap<double, Node*> nodes;
+};
+
+AdvancingFront::AdvancingFront(Node& head, Node& tail) : index_(new NodeIndex)
 {
   head_ = &head;
   tail_ = &tail;
   search_node_ = &head;
+  AddNode(head_);
+  AddNode(tail_);
 }
 
 Node* AdvancingFront::LocateNode(const double& x)
 {
+  // Consecutive points are often close, try the last position first
   Node* node = search_node_;
+  if (node->value <= x && node->next && x < node->next->value) {
+    return node;
+  }
 
-  if (x < node->value) {
-    while ((node = node->prev) != NULL) {
-      if (x >= node->value) {
-        search_node_ = node;
-        return node;
-      }
-    }
-  } else {
-    while ((node = node->next) != NULL) {
-      if (x < node->value) {
-        search_node_ = node->prev;
-        return node->prev;
-      }
-    }
+  node = FindSearchNode(x);
+  if (node == NULL || node->next == NULL) {
+    return NULL;
   }
-  return NULL;
+  search_node_ = node;
+  return node;
 }
 
 Node* AdvancingFront::FindSearchNode(const double& x)
 {
-  (void)x; // suppress compiler warnings "unused parameter 'x'"
-  // TODO: implement BST index
-  return search_node_;
+  std::multimap<double, Node*>::iterator it = index_->nodes.upper_bound(x);
+  if (it == index_->nodes.begin()) {
+    return NULL;
+  }
+  Node* node = (--it)->second;
+
+  // Nodes with the same value are ordered along the front, not in the index
+  while (node->next && node->next->value <= x) {
+    node = node->next;
+  }
+  return node;
 }
 
 Node* AdvancingFront::LocatePoint(const Point* point)
 {
   const double px = point->x;
   Node* node = FindSearchNode(px);
-  const double nx = node->point->x;
 
-  if (px == nx) {
-    if (point != node->point) {
-      // We might have two nodes with same x value for a short time
-      if (point == node->prev->point) {
-        node = node->prev;
-      } else if (point == node->next->point) {
-        node = node->next;
-      } else {
-        assert(0);
-      }
-    }
-  } else if (px < nx) {
-    while ((node = node->prev) != NULL) {
-      if (point == node->point) {
-        break;
-      }
+  // We might have two nodes with same x value for a short time
+  while (node && node->value == px) {
+    if (node->point == point) {
+      search_node_ = node;
+      return node;
     }
-  } else {
-    while ((node = node->next) != NULL) {
-      if (point == node->point)
-        break;
+    node = node->prev;
+  }
+  return NULL;
+}
+
+void AdvancingFront::AddNode(Node* node)
+{
+  index_->nodes.insert(std::make_pair(node->value, node));
+}
+
+void AdvancingFront::RemoveNode(Node* node)
+{
+  std::pair<std::multimap<double, Node*>::iterator, std::multimap<double, Node*>::iterator> range =
+    index_->nodes.equal_range(node->value);
+  for (std::multimap<double, Node*>::iterator it = range.first; it != range.second; ++it) {
+    if (it->second == node) {
+      index_->nodes.erase(it);
+      break;
     }
   }
-  if(node) search_node_ = node;
-  return node;
+
+  // An unlinked node keeps its links, but it is no longer a valid position
+  if (search_node_ == node) {
+    search_node_ = node->prev;
+  }
 }
 
 AdvancingFront::~AdvancingFront()
 {
+  delete index_;
 }
 
 }
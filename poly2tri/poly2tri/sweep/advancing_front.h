@@ -37,6 +37,7 @@
 namespace p2t {
 
 struct Node;
+struct NodeIndex;
 
 // Advancing front node
 struct Node {
@@ -66,6 +67,9 @@ AdvancingFront(Node& head, Node& tail);
 // Destructor
 ~AdvancingFront();
 
+AdvancingFront(const AdvancingFront&) = delete;
+AdvancingFront& operator=(const AdvancingFront&) = delete;
+
 Node* head();
 void set_head(Node* node);
 Node* tail();
@@ -78,10 +82,20 @@ Node* LocateNode(const double& x);
 
 Node* LocatePoint(const Point* point);
 
+/// Keep the search index in sync with the front: add a node once it is
+/// linked into the front, remove it once it is unlinked
+void AddNode(Node* node);
+void RemoveNode(Node* node);
+
 private:
 
 Node* head_, *tail_, *search_node_;
 
+/// Nodes of the front by value. The front is ordered by value, so the
+/// index finds any position in O(log n) however far it is from search_node_
+NodeIndex* index_;
+
+/// Rightmost node with a value not greater than x, NULL if there is none
 Node* FindSearchNode(const double& x);
 };
 
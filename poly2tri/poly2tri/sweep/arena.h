@@ -0,0 +1,119 @@
+/*
+ * Poly2Tri Copyright (c) 2009-2010, Poly2Tri Contributors
+ * http://code.google.com/p/poly2tri/
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * * Neither the name of Poly2Tri nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace p2t {
+
+/// Allocates objects of type T in blocks and releases all of them at once.
+/// Objects never move, pointers to them stay valid until Clear() or the destruction of the arena.
+/// Blocks start small and double up to max_block_size, so small polygons don't pay for big blocks.
+template <class T>
+class Arena {
+public:
+
+  explicit Arena(size_t first_block_size = 32, size_t max_block_size = 1024)
+    : first_block_size_(first_block_size), max_block_size_(max_block_size), block_size_(0), used_(0),
+      size_(0)
+  {
+  }
+
+  ~Arena()
+  {
+    Clear();
+  }
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  /// Construct a new object in the current block
+  template <class... Args>
+  T* New(Args&&... args)
+  {
+    if (used_ == block_size_) {
+      block_size_ = blocks_.empty() ? first_block_size_ : std::min(2 * block_size_, max_block_size_);
+      blocks_.push_back(static_cast<T*>(::operator new(block_size_ * sizeof(T))));
+      used_ = 0;
+    }
+    T* object = new (blocks_.back() + used_) T(std::forward<Args>(args)...);
+    used_++;
+    size_++;
+    return object;
+  }
+
+  /// Destroy every object and release the blocks
+  void Clear()
+  {
+    size_t block_size = first_block_size_;
+    for (size_t i = 0; i < blocks_.size(); i++) {
+      const size_t count = i + 1 < blocks_.size() ? block_size : used_;
+      for (size_t j = 0; j < count; j++) {
+        blocks_[i][j].~T();
+      }
+      ::operator delete(blocks_[i]);
+      block_size = std::min(2 * block_size, max_block_size_);
+    }
+    blocks_.clear();
+    block_size_ = 0;
+    used_ = 0;
+    size_ = 0;
+  }
+
+  /// Number of objects
+  size_t size() const
+  {
+    return size_;
+  }
+
+private:
+
+  size_t first_block_size_;
+  size_t max_block_size_;
+  // size of the last block
+  size_t block_size_;
+  // objects in the last block
+  size_t used_;
+  size_t size_;
+  std::vector<T*> blocks_;
+
+};
+
+}
+
+#endif
@@ -82,12 +82,12 @@ public:
   /**
    * Get CDT triangles
    */
-  std::vector<Triangle*> GetTriangles();
+  const std::vector<Triangle*>& GetTriangles();
   
   /**
    * Get triangle map
    */
-  std::list<Triangle*> GetMap();
+  const std::vector<Triangle*>& GetMap();
 
   private:
 
@@ -40,7 +40,7 @@ namespace p2t {
 void Sweep::Triangulate(SweepContext& tcx)
 {
   tcx.InitTriangulation();
-  tcx.CreateAdvancingFront(nodes_);
+  tcx.CreateAdvancingFront();
   // Sweep points; build mesh
   SweepPoints(tcx);
   // Clean up
@@ -106,57 +106,68 @@ void Sweep::EdgeEvent(SweepContext& tcx, Edge* edge, Node* node)
 
 void Sweep::EdgeEvent(SweepContext& tcx, Point& ep, Point& eq, Triangle* triangle, Point& point)
 {
-  if (IsEdgeSideOfTriangle(*triangle, ep, eq)) {
-    return;
+  Point* q = &eq;
+  Point* p = &point;
+  if (LocateCrossingTriangle(tcx, ep, q, triangle, p)) {
+    // This triangle crosses constraint so lets flippin start!
+    FlipEdgeEvent(tcx, ep, *q, triangle, *p);
   }
+}
 
-  Point* p1 = triangle->PointCCW(point);
-  Orientation o1 = Orient2d(eq, *p1, ep);
-  if (o1 == COLLINEAR) {
-    if( triangle->Contains(&eq, p1)) {
-      triangle->MarkConstrainedEdge(&eq, p1 );
-      // We are modifying the constraint maybe it would be better to 
-      // not change the given constraint and just keep a variable for the new constraint
-      tcx.edge_event.constrained_edge->q = p1;
-      triangle = &triangle->NeighborAcross(point);
-      EdgeEvent( tcx, ep, *p1, triangle, *p1 );
-    } else {
-      std::runtime_error("EdgeEvent - collinear points not supported");
-      assert(0);
+bool Sweep::LocateCrossingTriangle(SweepContext& tcx, Point& ep, Point*& eq, Triangle*& triangle, Point*& point)
+{
+  while (!IsEdgeSideOfTriangle(*triangle, ep, *eq)) {
+    Point* p1 = triangle->PointCCW(*point);
+    Orientation o1 = Orient2d(*eq, *p1, ep);
+    if (o1 == COLLINEAR) {
+      if( triangle->Contains(eq, p1)) {
+        triangle->MarkConstrainedEdge(eq, p1 );
+        // We are modifying the constraint maybe it would be better to 
+        // not change the given constraint and just keep a variable for the new constraint
+        tcx.edge_event.constrained_edge->q = p1;
+        triangle = &triangle->NeighborAcross(*point);
+        eq = p1;
+        point = p1;
+        continue;
+      } else {
+        std::runtime_error("EdgeEvent - collinear points not supported");
+        assert(0);
+      }
+      return false;
     }
-    return;
-  }
 
-  Point* p2 = triangle->PointCW(point);
-  Orientation o2 = Orient2d(eq, *p2, ep);
-  if (o2 == COLLINEAR) {
-    if( triangle->Contains(&eq, p2)) {
-      triangle->MarkConstrainedEdge(&eq, p2 );
-      // We are modifying the constraint maybe it would be better to 
-      // not change the given constraint and just keep a variable for the new constraint
-      tcx.edge_event.constrained_edge->q = p2;
-      triangle = &triangle->NeighborAcross(point);
-      EdgeEvent( tcx, ep, *p2, triangle, *p2 );
-    } else {
-      std::runtime_error("EdgeEvent - collinear points not supported");
-      assert(0);
+    Point* p2 = triangle->PointCW(*point);
+    Orientation o2 = Orient2d(*eq, *p2, ep);
+    if (o2 == COLLINEAR) {
+      if( triangle->Contains(eq, p2)) {
+        triangle->MarkConstrainedEdge(eq, p2 );
+        // We are modifying the constraint maybe it would be better to 
+        // not change the given constraint and just keep a variable for the new constraint
+        tcx.edge_event.constrained_edge->q = p2;
+        triangle = &triangle->NeighborAcross(*point);
+        eq = p2;
+        point = p2;
+        continue;
+      } else {
+        std::runtime_error("EdgeEvent - collinear points not supported");
+        assert(0);
+      }
+      return false;
+    }
+
+    if (o1 != o2) {
+      return true;
     }
-    return;
-  }
 
-  if (o1 == o2) {
     // Need to decide if we are rotating CW or CCW to get to a triangle
     // that will cross edge
     if (o1 == CW) {
-      triangle = triangle->NeighborCCW(point);
-    }       else{
-      triangle = triangle->NeighborCW(point);
+      triangle = triangle->NeighborCCW(*point);
+    } else {
+      triangle = triangle->NeighborCW(*point);
     }
-    EdgeEvent(tcx, ep, eq, triangle, point);
-  } else {
-    // This triangle crosses constraint so lets flippin start!
-    FlipEdgeEvent(tcx, ep, eq, triangle, point);
   }
+  return false;
 }
 
 bool Sweep::IsEdgeSideOfTriangle(Triangle& triangle, Point& ep, Point& eq)
@@ -176,18 +187,18 @@ bool Sweep::IsEdgeSideOfTriangle(Triangle& triangle, Point& ep, Point& eq)
 
 Node& Sweep::NewFrontTriangle(SweepContext& tcx, Point& point, Node& node)
 {
-  Triangle* triangle = new Triangle(point, *node.point, *node.next->point);
+  Triangle* triangle = tcx.NewTriangle(point, *node.point, *node.next->point);
 
   triangle->MarkNeighbor(*node.triangle);
   tcx.AddToMap(triangle);
 
-  Node* new_node = new Node(point);
-  nodes_.push_back(new_node);
+  Node* new_node = tcx.NewNode(point);
 
   new_node->next = node.next;
   new_node->prev = &node;
   node.next->prev = new_node;
   node.next = new_node;
+  tcx.front()->AddNode(new_node);
 
   if (!Legalize(tcx, *triangle)) {
     tcx.MapTriangleToNodes(*triangle);
@@ -198,7 +209,7 @@ Node& Sweep::NewFrontTriangle(SweepContext& tcx, Point& point, Node& node)
 
 void Sweep::Fill(SweepContext& tcx, Node& node)
 {
-  Triangle* triangle = new Triangle(*node.prev->point, *node.point, *node.next->point);
+  Triangle* triangle = tcx.NewTriangle(*node.prev->point, *node.point, *node.next->point);
 
   // TODO: should copy the constrained_edge value from neighbor triangles
   //       for now constrained_edge values are copied during the legalize
@@ -210,6 +221,7 @@ void Sweep::Fill(SweepContext& tcx, Node& node)
   // Update the advancing front
   node.prev->next = node.next;
   node.next->prev = node.prev;
+  tcx.front()->RemoveNode(&node);
 
   // If it was legalized the triangle has already been mapped
   if (!Legalize(tcx, *triangle)) {
@@ -329,69 +341,103 @@ double Sweep::HoleAngle(Node& node)
   return atan2(ax * by - ay * bx, ax * bx + ay * by);
 }
 
-bool Sweep::Legalize(SweepContext& tcx, Triangle& t)
+bool Sweep::Legalize(SweepContext& tcx, Triangle& triangle)
 {
-  // To legalize a triangle we start by finding if any of the three edges
-  // violate the Delaunay condition
-  for (int i = 0; i < 3; i++) {
-    if (t.delaunay_edge[i])
+  // Work stack instead of recursion: after a rotation a frame waits for the legalization of both
+  // triangles, "legalized" is the result of the frame which finished last
+  const size_t base = legalize_stack_.size();
+  legalize_stack_.push_back(LegalizeFrame(&triangle));
+  bool legalized = false;
+
+  while (legalize_stack_.size() > base) {
+    LegalizeFrame& frame = legalize_stack_.back();
+
+    if (frame.state == LegalizeFrame::LEGALIZE_TRIANGLE) {
+      // Make sure that triangle to node mapping is done only one time for a specific triangle
+      if (!legalized)
+        tcx.MapTriangleToNodes(*frame.t);
+      frame.state = LegalizeFrame::LEGALIZE_OPPOSITE;
+      Triangle* ot = frame.ot;
+      legalize_stack_.push_back(LegalizeFrame(ot));
+      CheckStackSize(tcx, legalize_stack_.size());
       continue;
+    }
 
-    Triangle* ot = t.GetNeighbor(i);
-
-    if (ot) {
-      Point* p = t.GetPoint(i);
-      Point* op = ot->OppositePoint(t, *p);
-      int oi = ot->Index(op);
+    if (frame.state == LegalizeFrame::LEGALIZE_OPPOSITE) {
+      if (!legalized)
+        tcx.MapTriangleToNodes(*frame.ot);
 
-      // If this is a Constrained Edge or a Delaunay Edge(only during recursive legalization)
-      // then we should not try to legalize
-      if (ot->constrained_edge[oi] || ot->delaunay_edge[oi]) {
-        t.constrained_edge[i] = ot->constrained_edge[oi];
-        continue;
-      }
+      // Reset the Delaunay edges, since they only are valid Delaunay edges
+      // until we add a new triangle or point.
+      frame.t->delaunay_edge[frame.i] = false;
+      frame.ot->delaunay_edge[frame.oi] = false;
 
-      bool inside = Incircle(*p, *t.PointCCW(*p), *t.PointCW(*p), *op);
+      // If triangle have been legalized no need to check the other edges since
+      // the legalization of the rotated pair handles those
+      legalized = true;
+      legalize_stack_.pop_back();
+      continue;
+    }
 
-      if (inside) {
-        // Lets mark this shared edge as Delaunay
-        t.delaunay_edge[i] = true;
-        ot->delaunay_edge[oi] = true;
+    // To legalize a triangle we start by finding if any of the three edges
+    // violate the Delaunay condition
+    Triangle& t = *frame.t;
+    bool rotated = false;
+    for (int i = 0; i < 3; i++) {
+      if (t.delaunay_edge[i])
+        continue;
 
-        // Lets rotate shared edge one vertex CW to legalize it
-        RotateTrianglePair(t, *p, *ot, *op);
+      Triangle* ot = t.GetNeighbor(i);
 
-        // We now got one valid Delaunay Edge shared by two triangles
-        // This gives us 4 new edges to check for Delaunay
+      if (ot) {
+        Point* p = t.GetPoint(i);
+        Point* op = ot->OppositePoint(t, *p);
+        int oi = ot->Index(op);
 
-        // Make sure that triangle to node mapping is done only one time for a specific triangle
-        bool not_legalized = !Legalize(tcx, t);
-        if (not_legalized) {
-          tcx.MapTriangleToNodes(t);
+        // If this is a Constrained Edge or a Delaunay Edge(only during recursive legalization)
+        // then we should not try to legalize
+        if (ot->constrained_edge[oi] || ot->delaunay_edge[oi]) {
+          t.constrained_edge[i] = ot->constrained_edge[oi];
+          continue;
         }
 
-        not_legalized = !Legalize(tcx, *ot);
-        if (not_legalized)
-          tcx.MapTriangleToNodes(*ot);
+        bool inside = Incircle(*p, *t.PointCCW(*p), *t.PointCW(*p), *op);
+
+        if (inside) {
+          // Lets mark this shared edge as Delaunay
+          t.delaunay_edge[i] = true;
+          ot->delaunay_edge[oi] = true;
 
-        // Reset the Delaunay edges, since they only are valid Delaunay edges
-        // until we add a new triangle or point.
-        // XXX: need to think about this. Can these edges be tried after we
-        //      return to previous recursive level?
-        t.delaunay_edge[i] = false;
-        ot->delaunay_edge[oi] = false;
+          // Lets rotate shared edge one vertex CW to legalize it
+          RotateTrianglePair(t, *p, *ot, *op);
 
-        // If triangle have been legalized no need to check the other edges since
-        // the recursive legalization will handles those so we can end here.
-        return true;
+          // We now got one valid Delaunay Edge shared by two triangles
+          // This gives us 4 new edges to check for Delaunay
+          frame.ot = ot;
+          frame.i = i;
+          frame.oi = oi;
+          frame.state = LegalizeFrame::LEGALIZE_TRIANGLE;
+          rotated = true;
+          break;
+        }
       }
     }
+
+    if (rotated) {
+      legalize_stack_.push_back(LegalizeFrame(&t));
+      CheckStackSize(tcx, legalize_stack_.size());
+    } else {
+      legalized = false;
+      legalize_stack_.pop_back();
+    }
   }
-  return false;
+  return legalized;
 }
 
 bool Sweep::Incircle(Point& pa, Point& pb, Point& pc, Point& pd)
 {
+  // Every sign is filtered with the error bound of its products, see Orient2d,
+  // and evaluated exactly only if the filter can't decide
   double adx = pa.x - pd.x;
   double ady = pa.y - pd.y;
   double bdx = pb.x - pd.x;
@@ -401,7 +447,8 @@ bool Sweep::Incircle(Point& pa, Point& pb, Point& pc, Point& pd)
   double bdxady = bdx * ady;
   double oabd = adxbdy - bdxady;
 
-  if (oabd <= 0)
+  double bound = ORIENT2D_BOUND * (fabs(adxbdy) + fabs(bdxady));
+  if (oabd <= bound && (oabd < -bound || Orient2d(pa, pb, pd) != CCW))
     return false;
 
   double cdx = pc.x - pd.x;
@@ -411,7 +458,8 @@ bool Sweep::Incircle(Point& pa, Point& pb, Point& pc, Point& pd)
   double adxcdy = adx * cdy;
   double ocad = cdxady - adxcdy;
 
-  if (ocad <= 0)
+  bound = ORIENT2D_BOUND * (fabs(cdxady) + fabs(adxcdy));
+  if (ocad <= bound && (ocad < -bound || Orient2d(pc, pa, pd) != CCW))
     return false;
 
   double bdxcdy = bdx * cdy;
@@ -423,7 +471,14 @@ bool Sweep::Incircle(Point& pa, Point& pb, Point& pc, Point& pd)
 
   double det = alift * (bdxcdy - cdxbdy) + blift * ocad + clift * oabd;
 
-  return det > 0;
+  double permanent = (fabs(bdxcdy) + fabs(cdxbdy)) * alift + (fabs(cdxady) + fabs(adxcdy)) * blift +
+                     (fabs(adxbdy) + fabs(bdxady)) * clift;
+  bound = INCIRCLE_BOUND * permanent;
+  if (det > bound)
+    return true;
+  if (det < -bound)
+    return false;
+  return Incircle2dAdapt(pa, pb, pc, pd, permanent) > 0;
 }
 
 void Sweep::RotateTrianglePair(Triangle& t, Point& p, Triangle& ot, Point& op)
@@ -513,36 +568,32 @@ void Sweep::FillBasin(SweepContext& tcx, Node& node)
 void Sweep::FillBasinReq(SweepContext& tcx, Node* node)
 {
   // if shallow stop filling
-  if (IsShallow(tcx, *node)) {
-    return;
-  }
-
-  Fill(tcx, *node);
+  while (!IsShallow(tcx, *node)) {
+    Fill(tcx, *node);
 
-  if (node->prev == tcx.basin.left_node && node->next == tcx.basin.right_node) {
-    return;
-  } else if (node->prev == tcx.basin.left_node) {
-    Orientation o = Orient2d(*node->point, *node->next->point, *node->next->next->point);
-    if (o == CW) {
-      return;
-    }
-    node = node->next;
-  } else if (node->next == tcx.basin.right_node) {
-    Orientation o = Orient2d(*node->point, *node->prev->point, *node->prev->prev->point);
-    if (o == CCW) {
+    if (node->prev == tcx.basin.left_node && node->next == tcx.basin.right_node) {
       return;
-    }
-    node = node->prev;
-  } else {
-    // Continue with the neighbor node with lowest Y value
-    if (node->prev->point->y < node->next->point->y) {
+    } else if (node->prev == tcx.basin.left_node) {
+      Orientation o = Orient2d(*node->point, *node->next->point, *node->next->next->point);
+      if (o == CW) {
+        return;
+      }
+      node = node->next;
+    } else if (node->next == tcx.basin.right_node) {
+      Orientation o = Orient2d(*node->point, *node->prev->point, *node->prev->prev->point);
+      if (o == CCW) {
+        return;
+      }
       node = node->prev;
     } else {
-      node = node->next;
+      // Continue with the neighbor node with lowest Y value
+      if (node->prev->point->y < node->next->point->y) {
+        node = node->prev;
+      } else {
+        node = node->next;
+      }
     }
   }
-
-  FillBasinReq(tcx, node);
 }
 
 bool Sweep::IsShallow(SweepContext& tcx, Node& node)
@@ -697,42 +748,70 @@ void Sweep::FillLeftConcaveEdgeEvent(SweepContext& tcx, Edge* edge, Node& node)
 
 }
 
-void Sweep::FlipEdgeEvent(SweepContext& tcx, Point& ep, Point& eq, Triangle* t, Point& p)
+void Sweep::FlipEdgeEvent(SweepContext& tcx, Point& edge_p, Point& edge_q, Triangle* triangle, Point& point)
 {
-  Triangle& ot = t->NeighborAcross(p);
-  Point& op = *ot.OppositePoint(*t, p);
-
-  if (&ot == NULL) {
-    // If we want to integrate the fillEdgeEvent do it here
-    // With current implementation we should never get here
-    //throw new RuntimeException( "[BUG:FIXME] FLIP failed due to missing triangle");
-    assert(0);
-  }
-
-  if (InScanArea(p, *t->PointCCW(p), *t->PointCW(p), op)) {
-    // Lets rotate shared edge one vertex CW
-    RotateTrianglePair(*t, p, ot, op);
-    tcx.MapTriangleToNodes(*t);
-    tcx.MapTriangleToNodes(ot);
+  // Loop instead of recursion: the edge event which follows a flip scan waits on a work stack
+  // until the flips started by the scan are done
+  const size_t base = edge_event_stack_.size();
+  EdgeEventFrame flip(edge_p, edge_q, triangle, point);
+
+  for (;;) {
+    Point& ep = *flip.ep;
+    Point& eq = *flip.eq;
+    Triangle* t = flip.triangle;
+    Point& p = *flip.point;
+
+    Triangle& ot = t->NeighborAcross(p);
+    Point& op = *ot.OppositePoint(*t, p);
+
+    if (&ot == NULL) {
+      // If we want to integrate the fillEdgeEvent do it here
+      // With current implementation we should never get here
+      //throw new RuntimeException( "[BUG:FIXME] FLIP failed due to missing triangle");
+      assert(0);
+    }
 
-    if (p == eq && op == ep) {
-      if (eq == *tcx.edge_event.constrained_edge->q && ep == *tcx.edge_event.constrained_edge->p) {
-        t->MarkConstrainedEdge(&ep, &eq);
-        ot.MarkConstrainedEdge(&ep, &eq);
-        Legalize(tcx, *t);
-        Legalize(tcx, ot);
+    if (InScanArea(p, *t->PointCCW(p), *t->PointCW(p), op)) {
+      // Lets rotate shared edge one vertex CW
+      RotateTrianglePair(*t, p, ot, op);
+      tcx.MapTriangleToNodes(*t);
+      tcx.MapTriangleToNodes(ot);
+
+      if (p == eq && op == ep) {
+        if (eq == *tcx.edge_event.constrained_edge->q && ep == *tcx.edge_event.constrained_edge->p) {
+          t->MarkConstrainedEdge(&ep, &eq);
+          ot.MarkConstrainedEdge(&ep, &eq);
+          Legalize(tcx, *t);
+          Legalize(tcx, ot);
+        } else {
+          // XXX: I think one of the triangles should be legalized here?
+        }
       } else {
-        // XXX: I think one of the triangles should be legalized here?
+        Orientation o = Orient2d(eq, op, ep);
+        flip.triangle = &NextFlipTriangle(tcx, (int)o, *t, ot, p, op);
+        continue;
       }
     } else {
-      Orientation o = Orient2d(eq, op, ep);
-      t = &NextFlipTriangle(tcx, (int)o, *t, ot, p, op);
-      FlipEdgeEvent(tcx, ep, eq, t, p);
+      Point& newP = NextFlipPoint(ep, eq, ot, op);
+      edge_event_stack_.push_back(flip);
+      CheckStackSize(tcx, edge_event_stack_.size());
+      Triangle* scan_triangle = &ot;
+      Point* scan_point = &newP;
+      FlipScanEdgeEvent(ep, eq, *t, scan_triangle, scan_point);
+      // flip with new edge op->eq
+      flip = EdgeEventFrame(eq, *scan_point, scan_triangle, *scan_point);
+      continue;
     }
-  } else {
-    Point& newP = NextFlipPoint(ep, eq, ot, op);
-    FlipScanEdgeEvent(tcx, ep, eq, *t, ot, newP);
-    EdgeEvent(tcx, ep, eq, t, p);
+
+    // This flip is done, resume the edge events which waited for it
+    bool flipping = false;
+    while (!flipping && edge_event_stack_.size() > base) {
+      flip = edge_event_stack_.back();
+      edge_event_stack_.pop_back();
+      flipping = LocateCrossingTriangle(tcx, *flip.ep, flip.eq, flip.triangle, flip.point);
+    }
+    if (!flipping)
+      return;
   }
 }
 
@@ -771,42 +850,38 @@ Point& Sweep::NextFlipPoint(Point& ep, Point& eq, Triangle& ot, Point& op)
   }
 }
 
-void Sweep::FlipScanEdgeEvent(SweepContext& tcx, Point& ep, Point& eq, Triangle& flip_triangle,
-                              Triangle& t, Point& p)
+void Sweep::FlipScanEdgeEvent(Point& ep, Point& eq, Triangle& flip_triangle,
+                              Triangle*& t, Point*& p)
 {
-  Triangle& ot = t.NeighborAcross(p);
-  Point& op = *ot.OppositePoint(t, p);
+  for (;;) {
+    Triangle& ot = t->NeighborAcross(*p);
+    Point& op = *ot.OppositePoint(*t, *p);
+
+    if (&t->NeighborAcross(*p) == NULL) {
+      // If we want to integrate the fillEdgeEvent do it here
+      // With current implementation we should never get here
+      //throw new RuntimeException( "[BUG:FIXME] FLIP failed due to missing triangle");
+      assert(0);
+    }
 
-  if (&t.NeighborAcross(p) == NULL) {
-    // If we want to integrate the fillEdgeEvent do it here
-    // With current implementation we should never get here
-    //throw new RuntimeException( "[BUG:FIXME] FLIP failed due to missing triangle");
-    assert(0);
+    if (InScanArea(eq, *flip_triangle.PointCCW(eq), *flip_triangle.PointCW(eq), op)) {
+      // flip with new edge op->eq, started by the caller
+      t = &ot;
+      p = &op;
+      return;
+    }
+
+    p = &NextFlipPoint(ep, eq, ot, op);
+    t = &ot;
   }
+}
 
-  if (InScanArea(eq, *flip_triangle.PointCCW(eq), *flip_triangle.PointCW(eq), op)) {
-    // flip with new edge op->eq
-    FlipEdgeEvent(tcx, eq, op, &ot, op);
-    // TODO: Actually I just figured out that it should be possible to
-    //       improve this by getting the next ot and op before the the above
-    //       flip and continue the flipScanEdgeEvent here
-    // set new ot and op here and loop back to inScanArea test
-    // also need to set a new flip_triangle first
-    // Turns out at first glance that this is somewhat complicated
-    // so it will have to wait.
-  } else{
-    Point& newP = NextFlipPoint(ep, eq, ot, op);
-    FlipScanEdgeEvent(tcx, ep, eq, flip_triangle, ot, newP);
-  }
-}
-
-Sweep::~Sweep() {
-
-    // Clean up memory
-    for(int i = 0; i < nodes_.size(); i++) {
-        delete nodes_[i];
-    }
-
+void Sweep::CheckStackSize(SweepContext& tcx, size_t size)
+{
+  const size_t max_frames_per_triangle = 4;
+  if (size > max_frames_per_triangle * (tcx.GetMap().size() + 1)) {
+    throw std::runtime_error("poly2tri: legalization did not converge");
+  }
 }
 
 }
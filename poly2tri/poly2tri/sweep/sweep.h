@@ -39,6 +39,7 @@
 #ifndef SWEEP_H
 #define SWEEP_H
 
+#include <cstddef>
 #include <vector>
 
 namespace p2t {
@@ -59,11 +60,6 @@ public:
    * @param tcx
    */
   void Triangulate(SweepContext& tcx);
-  
-  /**
-   * Destructor - clean up memory
-   */
-  ~Sweep();
 
 private:
 
@@ -96,6 +92,14 @@ private:
 
   void EdgeEvent(SweepContext& tcx, Point& ep, Point& eq, Triangle* triangle, Point& point);
 
+  /**
+   * Walk from triangle to the triangle which crosses the edge ep-eq. Collinear
+   * points on the edge are constrained on the way and move eq, triangle and point.
+   *
+   * @return false if the edge is already a side of a triangle
+   */
+  bool LocateCrossingTriangle(SweepContext& tcx, Point& ep, Point*& eq, Triangle*& triangle, Point*& point);
+
   /**
    * Creates a new front triangle and legalize it
    * 
@@ -200,11 +204,10 @@ private:
   void FillBasin(SweepContext& tcx, Node& node);
 
   /**
-   * Recursive algorithm to fill a Basin with triangles
+   * Fill a Basin with triangles, one node after the other
    *
    * @param tcx
    * @param node - bottom_node
-   * @param cnt - counter used to alternate on even and odd numbers
    */
   void FillBasinReq(SweepContext& tcx, Node* node);
 
@@ -265,18 +268,58 @@ private:
      * point that is inside the flip triangle scan area. When found 
      * we generate a new flipEdgeEvent
      * 
-     * @param tcx
      * @param ep - last point on the edge we are traversing
      * @param eq - first point on the edge we are traversing
      * @param flipTriangle - the current triangle sharing the point eq with edge
-     * @param t
-     * @param p
+     * @param t - in: triangle to scan from, out: triangle of the new flipEdgeEvent
+     * @param p - in: point to scan from, out: point of the new flipEdgeEvent, its edge is eq->p
      */
-  void FlipScanEdgeEvent(SweepContext& tcx, Point& ep, Point& eq, Triangle& flip_triangle, Triangle& t, Point& p);
+  void FlipScanEdgeEvent(Point& ep, Point& eq, Triangle& flip_triangle, Triangle*& t, Point*& p);
+
+  /**
+   * A work stack never needs more frames than a few per triangle. Deeper stacks mean that
+   * the legalization cycles, e.g. on self-intersecting input, so this throws instead of
+   * letting them grow until memory runs out
+   *
+   * @param tcx
+   * @param size - size of the work stack after a push
+   */
+  void CheckStackSize(SweepContext& tcx, size_t size);
 
   void FinalizationPolygon(SweepContext& tcx);
 
-  std::vector<Node*> nodes_;
+  /// Triangle waiting in Legalize
+  struct LegalizeFrame {
+    enum State { CHECK_EDGES, LEGALIZE_TRIANGLE, LEGALIZE_OPPOSITE };
+
+    Triangle* t;
+    /// Triangle rotated with t, and the index of the shared edge in both
+    Triangle* ot;
+    int i, oi;
+    State state;
+
+    explicit LegalizeFrame(Triangle* t) : t(t), ot(NULL), i(0), oi(0), state(CHECK_EDGES)
+    {
+    }
+  };
+
+  /// Edge event waiting in FlipEdgeEvent for the flips of a flip scan
+  struct EdgeEventFrame {
+    Point* ep;
+    Point* eq;
+    Triangle* triangle;
+    Point* point;
+
+    EdgeEventFrame(Point& ep, Point& eq, Triangle* triangle, Point& point)
+      : ep(&ep), eq(&eq), triangle(triangle), point(&point)
+    {
+    }
+  };
+
+  /// Work stacks of the legalization and the flips, kept between calls so that
+  /// deep cascades don't use the thread stack and don't allocate after warm up
+  std::vector<LegalizeFrame> legalize_stack_;
+  std::vector<EdgeEventFrame> edge_event_stack_;
 
 };
 
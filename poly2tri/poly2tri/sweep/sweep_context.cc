@@ -62,12 +62,12 @@ void SweepContext::AddPoint(Point* point) {
   points_.push_back(point);
 }
 
-std::vector<Triangle*> SweepContext::GetTriangles()
+const std::vector<Triangle*>& SweepContext::GetTriangles()
 {
   return triangles_;
 }
 
-std::list<Triangle*> SweepContext::GetMap()
+const std::vector<Triangle*>& SweepContext::GetMap()
 {
   return map_;
 }
@@ -105,7 +105,7 @@ void SweepContext::InitEdges(std::vector<Point*> polyline)
   int num_points = polyline.size();
   for (int i = 0; i < num_points; i++) {
     int j = i < num_points - 1 ? i + 1 : 0;
-    edge_list.push_back(new Edge(*polyline[i], *polyline[j]));
+    edge_list.push_back(edge_arena_.New(*polyline[i], *polyline[j]));
   }
 }
 
@@ -116,27 +116,40 @@ Point* SweepContext::GetPoint(const int& index)
 
 void SweepContext::AddToMap(Triangle* triangle)
 {
+  triangle->map_index_ = static_cast<int>(map_.size());
   map_.push_back(triangle);
 }
 
 Node& SweepContext::LocateNode(Point& point)
 {
-  // TODO implement search tree
   return *front_->LocateNode(point.x);
 }
 
-void SweepContext::CreateAdvancingFront(std::vector<Node*> nodes)
+Triangle* SweepContext::NewTriangle(Point& a, Point& b, Point& c)
 {
+  return triangle_arena_.New(a, b, c);
+}
 
-  (void) nodes;
+Node* SweepContext::NewNode(Point& point)
+{
+  return node_arena_.New(point);
+}
+
+Node* SweepContext::NewNode(Point& point, Triangle& triangle)
+{
+  return node_arena_.New(point, triangle);
+}
+
+void SweepContext::CreateAdvancingFront()
+{
   // Initial triangle
-  Triangle* triangle = new Triangle(*points_[0], *tail_, *head_);
+  Triangle* triangle = NewTriangle(*points_[0], *tail_, *head_);
 
-  map_.push_back(triangle);
+  AddToMap(triangle);
 
-  af_head_ = new Node(*triangle->GetPoint(1), *triangle);
-  af_middle_ = new Node(*triangle->GetPoint(0), *triangle);
-  af_tail_ = new Node(*triangle->GetPoint(2));
+  af_head_ = NewNode(*triangle->GetPoint(1), *triangle);
+  af_middle_ = NewNode(*triangle->GetPoint(0), *triangle);
+  af_tail_ = NewNode(*triangle->GetPoint(2));
   front_ = new AdvancingFront(*af_head_, *af_tail_);
 
   // TODO: More intuitive if head is middles next and not previous?
@@ -145,11 +158,7 @@ void SweepContext::CreateAdvancingFront(std::vector<Node*> nodes)
   af_middle_->next = af_tail_;
   af_middle_->prev = af_head_;
   af_tail_->prev = af_middle_;
-}
-
-void SweepContext::RemoveNode(Node* node)
-{
-  delete node;
+  front_->AddNode(af_middle_);
 }
 
 void SweepContext::MapTriangleToNodes(Triangle& t)
@@ -165,7 +174,15 @@ void SweepContext::MapTriangleToNodes(Triangle& t)
 
 void SweepContext::RemoveFromMap(Triangle* triangle)
 {
-  map_.remove(triangle);
+  const int index = triangle->map_index_;
+  if (index < 0 || map_[index] != triangle)
+    return;
+
+  // Move the last triangle into the gap
+  map_[index] = map_.back();
+  map_[index]->map_index_ = index;
+  map_.pop_back();
+  triangle->map_index_ = -1;
 }
 
 void SweepContext::MeshClean(Triangle& triangle)
@@ -193,23 +210,10 @@ SweepContext::~SweepContext()
 
     // Clean up memory
 
+    // triangles, nodes and edges go with their arenas
     delete head_;
     delete tail_;
     delete front_;
-    delete af_head_;
-    delete af_middle_;
-    delete af_tail_;
-
-    typedef std::list<Triangle*> type_list;
-
-    for(type_list::iterator iter = map_.begin(); iter != map_.end(); ++iter) {
-        Triangle* ptr = *iter;
-        delete ptr;
-    }
-
-     for(unsigned int i = 0; i < edge_list.size(); i++) {
-        delete edge_list[i];
-    }
 
 }
 
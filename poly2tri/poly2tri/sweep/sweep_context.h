@@ -32,9 +32,9 @@
 #ifndef SWEEP_CONTEXT_H
 #define SWEEP_CONTEXT_H
 
-#include <list>
 #include <vector>
 #include <cstddef>
+#include "arena.h"
 
 namespace p2t {
 
@@ -68,9 +68,12 @@ int point_count();
 
 Node& LocateNode(Point& point);
 
-void RemoveNode(Node* node);
+/// Triangles and front nodes are owned by the context and released with it
+Triangle* NewTriangle(Point& a, Point& b, Point& c);
+Node* NewNode(Point& point);
+Node* NewNode(Point& point, Triangle& triangle);
 
-void CreateAdvancingFront(std::vector<Node*> nodes);
+void CreateAdvancingFront();
 
 /// Try to map a node to all sides of this triangle that don't have a neighbor
 void MapTriangleToNodes(Triangle& t);
@@ -91,8 +94,10 @@ AdvancingFront* front();
 
 void MeshClean(Triangle& triangle);
 
-std::vector<Triangle*> GetTriangles();
-std::list<Triangle*> GetMap();
+/// Interior triangles, valid until the context is destroyed
+const std::vector<Triangle*>& GetTriangles();
+/// Every triangle of the sweep, in creation order unless triangles were removed
+const std::vector<Triangle*>& GetMap();
 
 std::vector<Edge*> edge_list;
 
@@ -134,9 +139,14 @@ private:
 friend class Sweep;
 
 std::vector<Triangle*> triangles_;
-std::list<Triangle*> map_;
+std::vector<Triangle*> map_;
 std::vector<Point*> points_;
 
+// Storage of every triangle, front node and polygon edge of the triangulation
+Arena<Triangle> triangle_arena_;
+Arena<Node> node_arena_;
+Arena<Edge> edge_arena_;
+
 // Advancing front
 AdvancingFront* front_;
 // head point used with advancing front
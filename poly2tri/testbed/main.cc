@@ -41,7 +41,6 @@
 #include <iostream>
 #include <iterator>
 #include <limits>
-#include <list>
 #include <numeric>
 #include <sstream>
 #include <string>
@@ -87,7 +86,7 @@ double cy = 0.0;
 /// Constrained triangles
 vector<Triangle*> triangles;
 /// Triangle map
-list<Triangle*> map;
+vector<Triangle*> map;
 /// Polylines
 vector<Point*> polyline;
 vector<vector<Point*>> holes;
@@ -462,7 +461,7 @@ void DrawMap(const double zoom)
 
   ResetZoom(zoom, center.x, center.y, (double)default_window_width, (double)default_window_height);
 
-  list<Triangle*>::iterator it;
+  vector<Triangle*>::iterator it;
   for (it = map.begin(); it != map.end(); it++) {
     Triangle& t = **it;
     Point& a = *t.GetPoint(0);
@@ -0,0 +1,236 @@
+#include "AnalyticObjectInPathAnalyzer.hpp"
+#include "Triangulation.hpp"
+#include <algorithm> // std::sort std::lower_bound std::min std::max
+#include <cmath> // std::abs
+
+namespace
+{
+
+// overlaps smaller than this are rounding noise of edges which only touch
+constexpr float64_t AREA_EPSILON = 1e-9;
+
+} // namespace
+
+void AnalyticObjectInPathAnalyzer::process(const std::vector<LaneData>& lanes,
+                                           const std::vector<ObstacleData>& obstacles)
+{
+    process(lanes, obstacles, outputData_);
+    printLaneAssignment(outputData_);
+}
+
+void AnalyticObjectInPathAnalyzer::process(const std::vector<LaneData>& lanes,
+                                           const std::vector<ObstacleData>& obstacles,
+                                           std::vector<LaneAssignmentData>& result)
+{
+    makeLaneViews(lanes, laneViews_);
+    makeObstacleViews(obstacles, obstacleViews_);
+    process(laneViews_, obstacleViews_, result);
+}
+
+void AnalyticObjectInPathAnalyzer::process(const std::vector<LaneView>& lanes,
+                                           const std::vector<ObstacleView>& obstacles,
+                                           std::vector<LaneAssignmentData>& result)
+{
+    // broad phase: one box per lane segment, sorted along x. Rebuilt only when the lanes change
+    frameArena_.reset();
+    obstacleCache_.beginFrame();
+    laneCache_.update(lanes);
+    if (laneCache_.getRevision() != segmentsRevision_)
+    {
+        buildSegments();
+        segmentsRevision_ = laneCache_.getRevision();
+    }
+
+    laneAreas_.resize(lanes.size());
+    result.resize(obstacles.size());
+    for (size_t i = 0u; i < obstacles.size(); ++i)
+    {
+        LaneAssignmentData& elem = result[i];
+        elem.obstacleId = obstacles[i].id;
+        elem.laneIds.clear();
+        elem.intersectionPixelCounts.clear();
+        elem.obstacleTotalPixelCount = 0u;
+        elem.intersectionAreas.clear();
+        elem.coverageRatios.clear();
+        VertexSpan vertexData = obstacleCache_.triangulate(obstacles[i], frameArena_);
+        elem.obstacleVertexData.assign(vertexData.begin(), vertexData.end());
+
+        std::vector<Triangle>& triangles = obstacleTriangles_;
+        triangles.clear();
+        appendTriangles(vertexData.data, vertexData.size, triangles);
+
+        float64_t totalArea = 0.0;
+        float64_t minX = triangles.empty() ? 0.0 : triangles[0].p[0].x;
+        float64_t maxX = minX;
+        float64_t minY = triangles.empty() ? 0.0 : triangles[0].p[0].y;
+        float64_t maxY = minY;
+        for (const Triangle& tri : triangles)
+        {
+            totalArea += area(tri);
+            for (const Point2& p : tri.p)
+            {
+                minX = std::min(minX, p.x);
+                maxX = std::max(maxX, p.x);
+                minY = std::min(minY, p.y);
+                maxY = std::max(maxY, p.y);
+            }
+        }
+        elem.obstacleTotalArea = static_cast<float32_t>(totalArea);
+
+        // candidates: segments starting in [minX - maxSegmentWidth_, maxX] whose boxes overlap the obstacle's
+        std::fill(laneAreas_.begin(), laneAreas_.end(), 0.0);
+        auto it = std::lower_bound(segments_.begin(), segments_.end(), minX - maxSegmentWidth_,
+                                   [](const SegmentBox& box, float64_t x) { return box.minX < x; });
+        for (; it != segments_.end() && it->minX <= maxX; ++it)
+        {
+            if (it->maxX < minX || it->maxY < minY || it->minY > maxY)
+            {
+                continue;
+            }
+
+            // narrow phase: exact overlap of the obstacle triangles with the triangles of the segment
+            for (const Triangle& tri : triangles)
+            {
+                for (size_t t = it->firstTriangle; t < it->firstTriangle + it->triangleCount; ++t)
+                {
+                    laneAreas_[it->laneIndex] += intersectionArea(tri, laneTriangles_[t]);
+                }
+            }
+        }
+
+        for (size_t j = 0u; j < lanes.size(); ++j)
+        {
+            if (laneAreas_[j] > AREA_EPSILON)
+            {
+                elem.laneIds.push_back(lanes[j].id);
+                elem.intersectionAreas.push_back(static_cast<float32_t>(laneAreas_[j]));
+                elem.coverageRatios.push_back(static_cast<float32_t>(laneAreas_[j] / totalArea));
+            }
+        }
+    }
+}
+
+void AnalyticObjectInPathAnalyzer::buildSegments()
+{
+    laneTriangles_.clear();
+    segments_.clear();
+    maxSegmentWidth_ = 0.0;
+    for (size_t j = 0u; j < laneCache_.getLaneCount(); ++j)
+    {
+        // 6 vertices of 3 floats per segment, see trivialLaneTriangulation
+        const std::vector<float32_t>& laneVertexData = laneCache_.getVertexData(j);
+        for (size_t s = 0u; s + 18u <= laneVertexData.size(); s += 18u)
+        {
+            const float32_t* segment = laneVertexData.data() + s;
+            SegmentBox box{};
+            box.minX = box.maxX = segment[0];
+            box.minY = box.maxY = segment[1];
+            for (size_t k = 1u; k < 6u; ++k)
+            {
+                box.minX = std::min(box.minX, static_cast<float64_t>(segment[3u * k]));
+                box.maxX = std::max(box.maxX, static_cast<float64_t>(segment[3u * k]));
+                box.minY = std::min(box.minY, static_cast<float64_t>(segment[3u * k + 1u]));
+                box.maxY = std::max(box.maxY, static_cast<float64_t>(segment[3u * k + 1u]));
+            }
+            box.laneIndex = j;
+            box.firstTriangle = laneTriangles_.size();
+            appendTriangles(segment, 18u, laneTriangles_);
+            box.triangleCount = laneTriangles_.size() - box.firstTriangle;
+            if (box.triangleCount == 0u)
+            {
+                continue;
+            }
+            segments_.push_back(box);
+            maxSegmentWidth_ = std::max(maxSegmentWidth_, box.maxX - box.minX);
+        }
+    }
+    std::sort(segments_.begin(), segments_.end(),
+              [](const SegmentBox& a, const SegmentBox& b) { return a.minX < b.minX; });
+}
+
+void AnalyticObjectInPathAnalyzer::appendTriangles(const float32_t* vertexData,
+                                                   size_t floatCount,
+                                                   std::vector<Triangle>& triangles)
+{
+    const size_t triangleCount = floatCount / 9u;
+    for (size_t t = 0u; t < triangleCount; ++t)
+    {
+        const size_t first = 3u * t;
+
+        Triangle tri;
+        for (size_t k = 0u; k < 3u; ++k)
+        {
+            tri.p[k].x = vertexData[3u * (first + k)];
+            tri.p[k].y = vertexData[3u * (first + k) + 1u];
+        }
+
+        float64_t cross = (tri.p[1].x - tri.p[0].x) * (tri.p[2].y - tri.p[0].y) -
+                          (tri.p[2].x - tri.p[0].x) * (tri.p[1].y - tri.p[0].y);
+        if (cross == 0.0)
+        {
+            continue;
+        }
+        if (cross < 0.0)
+        {
+            std::swap(tri.p[1], tri.p[2]);
+        }
+        triangles.push_back(tri);
+    }
+}
+
+float64_t AnalyticObjectInPathAnalyzer::area(const Triangle& tri)
+{
+    return 0.5 * std::abs((tri.p[1].x - tri.p[0].x) * (tri.p[2].y - tri.p[0].y) -
+                          (tri.p[2].x - tri.p[0].x) * (tri.p[1].y - tri.p[0].y));
+}
+
+float64_t AnalyticObjectInPathAnalyzer::intersectionArea(const Triangle& subject, const Triangle& clip)
+{
+    // Sutherland-Hodgman: clip the subject by the 3 half planes of the clip triangle
+    // a triangle clipped by 3 half planes has at most 6 vertices
+    Point2 polygon[2][9];
+    size_t size = 3u;
+    std::copy(subject.p, subject.p + 3, polygon[0]);
+
+    for (size_t e = 0u; e < 3u && size > 0u; ++e)
+    {
+        const Point2& a = clip.p[e];
+        const Point2& b = clip.p[(e + 1u) % 3u];
+        const Point2* in = polygon[e % 2u];
+        Point2* out = polygon[(e + 1u) % 2u];
+
+        // d > 0 on the left of a -> b, i.e. inside
+        auto side = [&](const Point2& p) { return (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x); };
+
+        size_t outSize = 0u;
+        for (size_t k = 0u; k < size; ++k)
+        {
+            const Point2& p = in[k];
+            const Point2& q = in[(k + 1u) % size];
+            float64_t dp = side(p);
+            float64_t dq = side(q);
+            if (dp >= 0.0)
+            {
+                out[outSize++] = p;
+            }
+            if ((dp >= 0.0) != (dq >= 0.0))
+            {
+                float64_t s = dp / (dp - dq);
+                out[outSize++] = Point2{p.x + s * (q.x - p.x), p.y + s * (q.y - p.y)};
+            }
+        }
+        size = outSize;
+    }
+
+    // shoelace formula on the clipped polygon, which is in polygon[1] after 3 planes
+    const Point2* result = polygon[1];
+    float64_t twiceArea = 0.0;
+    for (size_t k = 0u; k < size; ++k)
+    {
+        const Point2& p = result[k];
+        const Point2& q = result[(k + 1u) % size];
+        twiceArea += p.x * q.y - q.x * p.y;
+    }
+
+    return 0.5 * std::abs(twiceArea);
+}
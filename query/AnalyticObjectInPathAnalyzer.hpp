@@ -0,0 +1,89 @@
+#ifndef ANALYTIC_OBJECT_IN_PATH_ANALYZER_HPP
+#define ANALYTIC_OBJECT_IN_PATH_ANALYZER_HPP
+
+#include "ObjectInPathAnalyzerBase.hpp"
+#include "FrameArena.hpp"
+#include "LaneCache.hpp"
+#include "ObstacleCache.hpp"
+
+// exact lane assignment without rasterization
+// every obstacle triangle is clipped against the lane triangles of trivialLaneTriangulation and the
+// overlap is measured in square world units, so the result does not depend on any framebuffer resolution.
+// The triangles of a lane are assumed not to overlap each other, as for well formed dividers
+class AnalyticObjectInPathAnalyzer
+{
+public:
+    // process lane assignment into "result". Only the area fields and ratios are filled
+    // the viewed points are only read during the call
+    void process(const std::vector<LaneView>& lanes,
+                 const std::vector<ObstacleView>& obstacles,
+                 std::vector<LaneAssignmentData>& result);
+
+    // same, viewing the elements of "lanes" and "obstacles"
+    void process(const std::vector<LaneData>& lanes,
+                 const std::vector<ObstacleData>& obstacles,
+                 std::vector<LaneAssignmentData>& result);
+
+    // process lane assignment into getLaneAssignmentData() and print it
+    void process(const std::vector<LaneData>& lanes, const std::vector<ObstacleData>& obstacles);
+
+    // result of the last printing lane assignment
+    const std::vector<LaneAssignmentData>& getLaneAssignmentData() const {return outputData_;};
+
+private:
+    struct Point2
+    {
+        float64_t x;
+        float64_t y;
+    };
+
+    struct Triangle
+    {
+        Point2 p[3];    // counter-clockwise
+    };
+
+    // bounding box of the 6 vertices of a lane segment, used to cull lane/obstacle pairs
+    struct SegmentBox
+    {
+        float64_t minX;
+        float64_t maxX;
+        float64_t minY;
+        float64_t maxY;
+        size_t laneIndex;
+        size_t firstTriangle;   // in laneTriangles_
+        size_t triangleCount;   // 0 to 2, a segment which narrows to a point has a degenerate triangle
+    };
+
+    std::vector<LaneAssignmentData> outputData_{};
+
+    /**** scratch data, kept to avoid allocations ****/
+    FrameArena frameArena_{};
+    ObstacleCache obstacleCache_{};     // polygon triangulations of the previous calls
+    std::vector<Triangle> obstacleTriangles_{};     // triangles of the current obstacle
+    std::vector<float64_t> laneAreas_{};    // overlap of the current obstacle with each lane
+    std::vector<LaneView> laneViews_{};
+    std::vector<ObstacleView> obstacleViews_{};
+
+    /**** lanes, rebuilt when laneCache_ changes ****/
+    LaneCache laneCache_{};
+    std::vector<Triangle> laneTriangles_{};
+    std::vector<SegmentBox> segments_{};    // sorted by minX
+    uint64_t segmentsRevision_{0u};         // revision of laneCache_ the segments were built from
+
+    // widest segment box, bounds how far left of an obstacle the candidate search has to start
+    float64_t maxSegmentWidth_{0.0};
+
+    // triangles and sorted segment boxes of the lanes of laneCache_
+    void buildSegments();
+
+    // append the triangles of GL_TRIANGLES vertex data, made counter-clockwise, degenerate ones dropped
+    static void appendTriangles(const float32_t* vertexData, size_t floatCount, std::vector<Triangle>& triangles);
+
+    // area of the intersection of two counter-clockwise triangles
+    static float64_t intersectionArea(const Triangle& subject, const Triangle& clip);
+
+    static float64_t area(const Triangle& tri);
+
+}; // class AnalyticObjectInPathAnalyzer
+
+#endif // ANALYTIC_OBJECT_IN_PATH_ANALYZER_HPP
@@ -0,0 +1,161 @@
+#include "AnalyzerPool.hpp"
+#include <algorithm> // std::max
+#include <stdexcept>
+#include <utility> // std::move
+
+AnalyzerPool::AnalyzerPool(uint32_t workerCount, const Factory& factory)
+{
+    // every factory call has returned before the constructor does, so "factory" may be captured by reference
+    std::vector<std::future<void>> ready{};
+    for (uint32_t i = 0u; i < std::max(workerCount, 1u); ++i)
+    {
+        workers_.push_back(std::unique_ptr<Worker>(new Worker{}));
+        Worker& worker = *workers_.back();
+
+        std::promise<void> promise{};
+        ready.push_back(promise.get_future());
+        worker.thread = std::thread([this, &worker, &factory, promise = std::move(promise)]() mutable {
+            std::unique_ptr<ObjectInPathAnalyzerBase> analyzer{};
+            try
+            {
+                analyzer = factory();
+                if (!analyzer)
+                {
+                    throw std::runtime_error("analyzer factory returned no analyzer\n");
+                }
+            }
+            catch (...)
+            {
+                promise.set_exception(std::current_exception());
+                return;
+            }
+            promise.set_value();
+
+            workerLoop(worker, std::move(analyzer));
+        });
+    }
+
+    for (std::future<void>& elem : ready)
+    {
+        try
+        {
+            elem.get();
+        }
+        catch (...)
+        {
+            shutdown();
+            throw;
+        }
+    }
+}
+
+AnalyzerPool::~AnalyzerPool()
+{
+    shutdown();
+}
+
+std::future<std::vector<LaneAssignmentData>> AnalyzerPool::process(uint32_t streamId,
+                                                                   std::vector<LaneData> lanes,
+                                                                   std::vector<ObstacleData> obstacles)
+{
+    std::packaged_task<std::vector<LaneAssignmentData>(ObjectInPathAnalyzerBase&)> task(
+        [lanes = std::move(lanes), obstacles = std::move(obstacles)](ObjectInPathAnalyzerBase& analyzer) {
+            std::vector<LaneAssignmentData> result{};
+            analyzer.process(lanes, obstacles, result);
+            return result;
+        });
+    std::future<std::vector<LaneAssignmentData>> result = task.get_future();
+    push(streamId, Job(std::move(task)));
+
+    return result;
+}
+
+std::future<std::vector<QueryCollisionData>> AnalyzerPool::process(uint32_t streamId,
+                                                                   FreespaceData freespace,
+                                                                   std::vector<ObstacleData> obstacles,
+                                                                   std::vector<ObstacleData> querys)
+{
+    std::packaged_task<std::vector<QueryCollisionData>(ObjectInPathAnalyzerBase&)> task(
+        [freespace = std::move(freespace), obstacles = std::move(obstacles), querys = std::move(querys)](
+            ObjectInPathAnalyzerBase& analyzer) {
+            std::vector<QueryCollisionData> result{};
+            analyzer.process(freespace, obstacles, querys, result);
+            return result;
+        });
+    std::future<std::vector<QueryCollisionData>> result = task.get_future();
+    push(streamId, Job(std::move(task)));
+
+    return result;
+}
+
+std::future<std::vector<TrajectoryCollisionData>> AnalyzerPool::process(uint32_t streamId,
+                                                                        FreespaceData freespace,
+                                                                        std::vector<ObstacleData> obstacles,
+                                                                        std::vector<TrajectoryData> trajectories)
+{
+    std::packaged_task<std::vector<TrajectoryCollisionData>(ObjectInPathAnalyzerBase&)> task(
+        [freespace = std::move(freespace), obstacles = std::move(obstacles), trajectories = std::move(trajectories)](
+            ObjectInPathAnalyzerBase& analyzer) {
+            std::vector<TrajectoryCollisionData> result{};
+            analyzer.process(freespace, obstacles, trajectories, result);
+            return result;
+        });
+    std::future<std::vector<TrajectoryCollisionData>> result = task.get_future();
+    push(streamId, Job(std::move(task)));
+
+    return result;
+}
+
+void AnalyzerPool::push(uint32_t streamId, Job job)
+{
+    Worker& worker = *workers_[streamId % workers_.size()];
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.queue.push_back(std::move(job));
+    }
+    worker.condition.notify_one();
+}
+
+void AnalyzerPool::workerLoop(Worker& worker, std::unique_ptr<ObjectInPathAnalyzerBase> analyzer)
+{
+    for (;;)
+    {
+        Job job{};
+        {
+            std::unique_lock<std::mutex> lock(worker.mutex);
+            worker.condition.wait(lock, [&worker]() { return worker.stop || !worker.queue.empty(); });
+            if (worker.queue.empty())
+            {
+                break;
+            }
+            job = std::move(worker.queue.front());
+            worker.queue.pop_front();
+        }
+
+        // exceptions are stored in the future of the request
+        job(*analyzer);
+    }
+
+    // destroyed on the thread which created it, while its context is still current
+    analyzer.reset();
+}
+
+void AnalyzerPool::shutdown()
+{
+    for (std::unique_ptr<Worker>& worker : workers_)
+    {
+        {
+            std::lock_guard<std::mutex> lock(worker->mutex);
+            worker->stop = true;
+        }
+        worker->condition.notify_one();
+    }
+    for (std::unique_ptr<Worker>& worker : workers_)
+    {
+        if (worker->thread.joinable())
+        {
+            worker->thread.join();
+        }
+    }
+    workers_.clear();
+}
@@ -0,0 +1,78 @@
+#ifndef ANALYZER_POOL_HPP
+#define ANALYZER_POOL_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ObjectInPathAnalyzerBase.hpp"
+
+// analyzers on worker threads, for several sensor streams processed concurrently
+// every worker owns one analyzer, created and destroyed on the worker thread by the factory, so that a
+// GL backend can make its own offscreen context current there. Requests of a stream always go to the same
+// worker: they are processed in submission order, by the same analyzer. Each call returns a future.
+class AnalyzerPool
+{
+public:
+    // called once on every worker thread. A GL factory creates and makes current a context first
+    using Factory = std::function<std::unique_ptr<ObjectInPathAnalyzerBase>()>;
+
+    // throws if a factory call throws
+    AnalyzerPool(uint32_t workerCount, const Factory& factory);
+
+    // queued requests are processed before the workers exit
+    ~AnalyzerPool();
+
+    AnalyzerPool(const AnalyzerPool&) = delete;
+    AnalyzerPool& operator=(const AnalyzerPool&) = delete;
+
+    uint32_t getWorkerCount() const {return static_cast<uint32_t>(workers_.size());};
+
+    // lane assignment of "streamId". An exception of the analyzer is rethrown by the future
+    std::future<std::vector<LaneAssignmentData>> process(uint32_t streamId,
+                                                         std::vector<LaneData> lanes,
+                                                         std::vector<ObstacleData> obstacles);
+
+    // collision of the querys with the freespace minus the obstacles, for "streamId"
+    std::future<std::vector<QueryCollisionData>> process(uint32_t streamId,
+                                                         FreespaceData freespace,
+                                                         std::vector<ObstacleData> obstacles,
+                                                         std::vector<ObstacleData> querys);
+
+    // trajectory sweep against the freespace minus the obstacles, for "streamId"
+    std::future<std::vector<TrajectoryCollisionData>> process(uint32_t streamId,
+                                                              FreespaceData freespace,
+                                                              std::vector<ObstacleData> obstacles,
+                                                              std::vector<TrajectoryData> trajectories);
+
+private:
+    using Job = std::packaged_task<void(ObjectInPathAnalyzerBase&)>;
+
+    struct Worker
+    {
+        std::thread thread{};
+        std::mutex mutex{};
+        std::condition_variable condition{};
+        std::deque<Job> queue{};    // protected by mutex
+        bool stop{false};           // protected by mutex
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers_{};
+
+    void workerLoop(Worker& worker, std::unique_ptr<ObjectInPathAnalyzerBase> analyzer);
+
+    void push(uint32_t streamId, Job job);
+
+    // stop and join every started worker
+    void shutdown();
+
+}; // class AnalyzerPool
+
+#endif // ANALYZER_POOL_HPP
@@ -0,0 +1,275 @@
+#include "CoherentAnalyzer.hpp"
+#include "LaneCache.hpp"
+#include <algorithm> // std::find std::min std::max
+#include <stdexcept>
+#include <utility> // std::move
+
+CoherentAnalyzer::CoherentAnalyzer(std::unique_ptr<ObjectInPathAnalyzerBase> analyzer,
+                                   float32_t tolerance,
+                                   uint32_t maxIdleFrames)
+    : analyzer_(std::move(analyzer))
+    , tolerance_(tolerance)
+    , maxIdleFrames_(maxIdleFrames)
+{
+    if (!analyzer_)
+    {
+        throw std::runtime_error("no analyzer to wrap\n");
+    }
+}
+
+void CoherentAnalyzer::process(const std::vector<LaneView>& lanes,
+                               const std::vector<ObstacleView>& obstacles,
+                               std::vector<LaneAssignmentData>& result)
+{
+    ++frame_;
+    const bool sameLaneOrder = updateLanes(lanes);
+
+    result.resize(obstacles.size());
+    recomputed_.clear();
+    recomputedIndices_.clear();
+    reusedCount_ = 0u;
+    for (size_t i = 0u; i < obstacles.size(); ++i)
+    {
+        const ObstacleView& obs = obstacles[i];
+        auto it = obstacles_.find(obs.id);
+        if (sameLaneOrder && it != obstacles_.end() && canReuse(obs, it->second, boundingBox(obs.boundaryPoints)))
+        {
+            it->second.lastFrame = frame_;
+            result[i] = it->second.result;
+            ++reusedCount_;
+        }
+        else
+        {
+            recomputed_.push_back(obs);
+            recomputedIndices_.push_back(i);
+        }
+    }
+
+    if (!recomputed_.empty())
+    {
+        analyzer_->process(lanes, recomputed_, recomputedResult_);
+        for (size_t k = 0u; k < recomputed_.size(); ++k)
+        {
+            const size_t i = recomputedIndices_[k];
+            result[i] = recomputedResult_[k];
+            store(obstacles[i], result[i]);
+        }
+    }
+
+    for (auto it = obstacles_.begin(); it != obstacles_.end();)
+    {
+        if (frame_ - it->second.lastFrame > maxIdleFrames_)
+        {
+            it = obstacles_.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void CoherentAnalyzer::process(const FreespaceBeams& freespace,
+                               const std::vector<ObstacleData>& obstacles,
+                               const std::vector<ObstacleData>& querys,
+                               std::vector<QueryCollisionData>& result)
+{
+    analyzer_->process(freespace, obstacles, querys, result);
+}
+
+void CoherentAnalyzer::process(const FreespaceBeams& freespace,
+                               const std::vector<ObstacleData>& obstacles,
+                               const std::vector<TrajectoryData>& trajectories,
+                               std::vector<TrajectoryCollisionData>& result)
+{
+    analyzer_->process(freespace, obstacles, trajectories, result);
+}
+
+void CoherentAnalyzer::reset()
+{
+    obstacles_.clear();
+    lanes_.clear();
+    laneOrder_.clear();
+}
+
+bool CoherentAnalyzer::updateLanes(const std::vector<LaneView>& lanes)
+{
+    currentLaneOrder_.clear();
+    dirtyLaneIds_.clear();
+    dirtyBoxes_.clear();
+    for (const LaneView& lane : lanes)
+    {
+        currentLaneOrder_.push_back(lane.id);
+
+        const uint64_t laneHash = LaneCache::hash(lane);
+        const Box left = boundingBox(lane.leftDiv);
+        const Box right = boundingBox(lane.rightDiv);
+        const Box box{std::min(left.minX, right.minX), std::max(left.maxX, right.maxX),
+                      std::min(left.minY, right.minY), std::max(left.maxY, right.maxY)};
+
+        auto it = lanes_.find(lane.id);
+        if (it == lanes_.end())
+        {
+            // a new lane only matters to the obstacles near it
+            LaneEntry& entry = lanes_[lane.id];
+            entry.hash = laneHash;
+            entry.box = box;
+            entry.firstFrame = frame_;
+            dirtyBoxes_.push_back(box);
+        }
+        else if (it->second.hash != laneHash)
+        {
+            dirtyLaneIds_.push_back(lane.id);
+            dirtyBoxes_.push_back(it->second.box);
+            dirtyBoxes_.push_back(box);
+            it->second.hash = laneHash;
+            it->second.box = box;
+        }
+        lanes_[lane.id].lastFrame = frame_;
+    }
+
+    // lanes which are gone invalidate the obstacles assigned to them
+    for (auto it = lanes_.begin(); it != lanes_.end();)
+    {
+        if (it->second.lastFrame != frame_)
+        {
+            dirtyLaneIds_.push_back(it->first);
+            it = lanes_.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    // the lanes of both calls, new and removed ones left out, have to be in the same order, so that the lane
+    // lists of reused and recomputed results follow the same order
+    bool sameOrder = true;
+    size_t previous = 0u;
+    for (uint32_t id : currentLaneOrder_)
+    {
+        if (lanes_[id].firstFrame == frame_)
+        {
+            continue;
+        }
+        while (previous < laneOrder_.size() && lanes_.find(laneOrder_[previous]) == lanes_.end())
+        {
+            ++previous;
+        }
+        if (previous == laneOrder_.size() || laneOrder_[previous] != id)
+        {
+            sameOrder = false;
+            break;
+        }
+        ++previous;
+    }
+    std::swap(laneOrder_, currentLaneOrder_);
+
+    return sameOrder;
+}
+
+bool CoherentAnalyzer::canReuse(const ObstacleView& obs, const ObstacleEntry& entry, const Box& box) const
+{
+    if (entry.shape != obs.shape || entry.ringSizes.size() != 1u + obs.holeCount ||
+        entry.ringSizes[0] != obs.boundaryPoints.size())
+    {
+        return false;
+    }
+    for (size_t k = 0u; k < obs.holeCount; ++k)
+    {
+        if (entry.ringSizes[1u + k] != obs.getHole(k).size())
+        {
+            return false;
+        }
+    }
+
+    // lanes
+    for (uint32_t laneId : entry.result.laneIds)
+    {
+        if (std::find(dirtyLaneIds_.begin(), dirtyLaneIds_.end(), laneId) != dirtyLaneIds_.end())
+        {
+            return false;
+        }
+    }
+    for (const Box& dirtyBox : dirtyBoxes_)
+    {
+        if (box.overlaps(dirtyBox, tolerance_))
+        {
+            return false;
+        }
+    }
+
+    // footprint, against the one the result was computed with, so that slow drifts are caught too
+    const float32_t tolerance2 = tolerance_ * tolerance_;
+    auto moved = [&](const PointArray& ring, size_t offset) {
+        for (size_t i = 0u; i < ring.size(); ++i)
+        {
+            const Point3f p = ring[i];
+            const Point3f& q = entry.points[offset + i];
+            if ((p.x - q.x) * (p.x - q.x) + (p.y - q.y) * (p.y - q.y) > tolerance2)
+            {
+                return true;
+            }
+        }
+        return false;
+    };
+    size_t offset = 0u;
+    if (moved(obs.boundaryPoints, offset))
+    {
+        return false;
+    }
+    offset += obs.boundaryPoints.size();
+    for (size_t k = 0u; k < obs.holeCount; ++k)
+    {
+        const PointArray hole = obs.getHole(k);
+        if (moved(hole, offset))
+        {
+            return false;
+        }
+        offset += hole.size();
+    }
+
+    return true;
+}
+
+void CoherentAnalyzer::store(const ObstacleView& obs, const LaneAssignmentData& result)
+{
+    ObstacleEntry& entry = obstacles_[obs.id];
+    entry.shape = obs.shape;
+    entry.points.clear();
+    entry.ringSizes.clear();
+    for (size_t i = 0u; i < obs.boundaryPoints.size(); ++i)
+    {
+        entry.points.push_back(obs.boundaryPoints[i]);
+    }
+    entry.ringSizes.push_back(obs.boundaryPoints.size());
+    for (size_t k = 0u; k < obs.holeCount; ++k)
+    {
+        const PointArray hole = obs.getHole(k);
+        for (size_t i = 0u; i < hole.size(); ++i)
+        {
+            entry.points.push_back(hole[i]);
+        }
+        entry.ringSizes.push_back(hole.size());
+    }
+    entry.lastFrame = frame_;
+    entry.result = result;
+}
+
+CoherentAnalyzer::Box CoherentAnalyzer::boundingBox(const PointArray& points)
+{
+    Box box{0.0f, 0.0f, 0.0f, 0.0f};
+    for (size_t i = 0u; i < points.size(); ++i)
+    {
+        const Point3f p = points[i];
+        if (i == 0u)
+        {
+            box = Box{p.x, p.x, p.y, p.y};
+        }
+        box.minX = std::min(box.minX, p.x);
+        box.maxX = std::max(box.maxX, p.x);
+        box.minY = std::min(box.minY, p.y);
+        box.maxY = std::max(box.maxY, p.y);
+    }
+    return box;
+}
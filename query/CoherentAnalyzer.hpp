@@ -0,0 +1,114 @@
+#ifndef COHERENT_ANALYZER_HPP
+#define COHERENT_ANALYZER_HPP
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "ObjectInPathAnalyzerBase.hpp"
+
+// temporal coherence for tracked obstacles: forwards every call to "analyzer", but the lane assignment
+// of an obstacle is reused from a previous frame, keyed by ObstacleData::id, as long as
+//   - no point of its outline and holes moved by more than "tolerance" metres since the frame its
+//     assignment was computed in, and the number of points and the shape are the same
+//   - no lane of its assignment changed or disappeared, and no new or changed lane comes near it
+//   - the lanes kept their order
+// Only the other obstacles are passed to the wrapped analyzer. A reused element is the one of the frame it
+// was computed in: pixel counts of that view and vertex data of that footprint.
+// Obstacles which were not seen during maxIdleFrames frames are forgotten.
+// The raster config is the one of the wrapped analyzer
+class CoherentAnalyzer : public ObjectInPathAnalyzerBase
+{
+public:
+    explicit CoherentAnalyzer(std::unique_ptr<ObjectInPathAnalyzerBase> analyzer,
+                              float32_t tolerance = 0.05f,
+                              uint32_t maxIdleFrames = 8u);
+
+    ObjectInPathAnalyzerBase& getAnalyzer() {return *analyzer_;};
+
+    using ObjectInPathAnalyzerBase::process;
+
+    void process(const std::vector<LaneView>& lanes,
+                 const std::vector<ObstacleView>& obstacles,
+                 std::vector<LaneAssignmentData>& result) override;
+
+    void process(const FreespaceBeams& freespace,
+                 const std::vector<ObstacleData>& obstacles,
+                 const std::vector<ObstacleData>& querys,
+                 std::vector<QueryCollisionData>& result) override;
+
+    void process(const FreespaceBeams& freespace,
+                 const std::vector<ObstacleData>& obstacles,
+                 const std::vector<TrajectoryData>& trajectories,
+                 std::vector<TrajectoryCollisionData>& result) override;
+
+    // obstacles of the last lane assignment whose result was reused, the others were recomputed
+    size_t getReusedCount() const {return reusedCount_;};
+    size_t getRecomputedCount() const {return recomputed_.size();};
+
+    // forget every obstacle and lane, e.g. after changing the raster config of the wrapped analyzer
+    void reset();
+
+private:
+    struct Box
+    {
+        float32_t minX;
+        float32_t maxX;
+        float32_t minY;
+        float32_t maxY;
+
+        bool overlaps(const Box& other, float32_t margin) const
+        {
+            return minX - margin <= other.maxX && other.minX <= maxX + margin &&
+                   minY - margin <= other.maxY && other.minY <= maxY + margin;
+        };
+    };
+
+    struct ObstacleEntry
+    {
+        ObstacleShape shape{ObstacleShape::QUAD};
+        std::vector<Point3f> points{};      // outline then holes, as they were when "result" was computed
+        std::vector<size_t> ringSizes{};    // outline then holes
+        uint64_t lastFrame{0u};
+        LaneAssignmentData result{};
+    };
+
+    struct LaneEntry
+    {
+        uint64_t hash{0u};
+        Box box{};
+        uint64_t firstFrame{0u};
+        uint64_t lastFrame{0u};
+    };
+
+    std::unique_ptr<ObjectInPathAnalyzerBase> analyzer_;
+    float32_t tolerance_;
+    uint32_t maxIdleFrames_;
+    uint64_t frame_{0u};
+
+    std::unordered_map<uint32_t, ObstacleEntry> obstacles_{};
+    std::unordered_map<uint32_t, LaneEntry> lanes_{};
+    std::vector<uint32_t> laneOrder_{};     // lane ids of the previous call
+
+    /**** scratch data, kept to avoid allocations ****/
+    std::vector<uint32_t> currentLaneOrder_{};
+    std::vector<uint32_t> dirtyLaneIds_{};  // lanes which changed or disappeared since the previous call
+    std::vector<Box> dirtyBoxes_{};         // boxes of the new lanes, old and new boxes of the changed ones
+    std::vector<ObstacleView> recomputed_{};
+    std::vector<size_t> recomputedIndices_{};
+    std::vector<LaneAssignmentData> recomputedResult_{};
+    size_t reusedCount_{0u};
+
+    // update lanes_ and find the dirty lanes. Returns false if the lane order changed, i.e. nothing can be reused
+    bool updateLanes(const std::vector<LaneView>& lanes);
+
+    bool canReuse(const ObstacleView& obs, const ObstacleEntry& entry, const Box& box) const;
+
+    // remember the footprint of "obs" and "result"
+    void store(const ObstacleView& obs, const LaneAssignmentData& result);
+
+    static Box boundingBox(const PointArray& points);
+
+}; // class CoherentAnalyzer
+
+#endif // COHERENT_ANALYZER_HPP
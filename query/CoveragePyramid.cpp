@@ -0,0 +1,183 @@
+#include "CoveragePyramid.hpp"
+#include <algorithm> // std::min std::max std::fill
+#include <cmath> // std::floor
+
+void CoveragePyramid::build(const LaneCache& lanes)
+{
+    const size_t laneCount = lanes.getLaneCount();
+    wordCount_ = (laneCount + 63u) / 64u;
+
+    size_t tileCount = 0u;
+    for (int32_t level = 0; level < LEVEL_COUNT; ++level)
+    {
+        levelOffsets_[level] = tileCount * wordCount_;
+        tileCount += static_cast<size_t>(LEVEL0_SIZE >> level) * (LEVEL0_SIZE >> level);
+    }
+    tiles_.assign(tileCount * wordCount_, 0u);
+
+    // grid bounds: every lane vertex
+    bool empty = true;
+    for (size_t j = 0u; j < laneCount; ++j)
+    {
+        const std::vector<float32_t>& vertexData = lanes.getVertexData(j);
+        for (size_t k = 0u; k + 2u < vertexData.size(); k += 3u)
+        {
+            if (empty)
+            {
+                minX_ = maxX_ = vertexData[k];
+                minY_ = maxY_ = vertexData[k + 1u];
+                empty = false;
+            }
+            minX_ = std::min(minX_, vertexData[k]);
+            maxX_ = std::max(maxX_, vertexData[k]);
+            minY_ = std::min(minY_, vertexData[k + 1u]);
+            maxY_ = std::max(maxY_, vertexData[k + 1u]);
+        }
+    }
+    if (empty)
+    {
+        minX_ = minY_ = maxX_ = maxY_ = 0.0f;
+    }
+    // a degenerate extent still gets tiles of non-zero size
+    tileWidth_ = std::max(maxX_ - minX_, 1e-3f) / LEVEL0_SIZE;
+    tileHeight_ = std::max(maxY_ - minY_, 1e-3f) / LEVEL0_SIZE;
+
+    // level 0: the bounding box of every lane triangle
+    for (size_t j = 0u; j < laneCount; ++j)
+    {
+        const std::vector<float32_t>& vertexData = lanes.getVertexData(j);
+        const uint64_t laneBit = uint64_t{1u} << (j % 64u);
+        for (size_t t = 0u; t + 8u < vertexData.size(); t += 9u)
+        {
+            const float32_t* p = &vertexData[t];
+            const int32_t x0 = getTileX(std::min({p[0], p[3], p[6]}));
+            const int32_t x1 = getTileX(std::max({p[0], p[3], p[6]}));
+            const int32_t y0 = getTileY(std::min({p[1], p[4], p[7]}));
+            const int32_t y1 = getTileY(std::max({p[1], p[4], p[7]}));
+            for (int32_t y = y0; y <= y1; ++y)
+            {
+                for (int32_t x = x0; x <= x1; ++x)
+                {
+                    getTile(0, x, y)[j / 64u] |= laneBit;
+                }
+            }
+        }
+    }
+
+    // coarser levels: union of the 4 tiles below
+    for (int32_t level = 1; level < LEVEL_COUNT; ++level)
+    {
+        const int32_t size = LEVEL0_SIZE >> level;
+        for (int32_t y = 0; y < size; ++y)
+        {
+            for (int32_t x = 0; x < size; ++x)
+            {
+                uint64_t* tile = getTile(level, x, y);
+                for (int32_t k = 0; k < 4; ++k)
+                {
+                    const uint64_t* child = getTile(level - 1, 2 * x + k % 2, 2 * y + k / 2);
+                    for (size_t w = 0u; w < wordCount_; ++w)
+                    {
+                        tile[w] |= child[w];
+                    }
+                }
+            }
+        }
+    }
+}
+
+void CoveragePyramid::query(const float32_t* vertexData,
+                            size_t floatCount,
+                            float32_t margin,
+                            uint64_t* candidates) const
+{
+    std::fill(candidates, candidates + wordCount_, 0u);
+    if (wordCount_ == 0u || floatCount < 3u)
+    {
+        return;
+    }
+
+    float32_t minX = vertexData[0];
+    float32_t maxX = minX;
+    float32_t minY = vertexData[1];
+    float32_t maxY = minY;
+    for (size_t k = 3u; k + 2u < floatCount; k += 3u)
+    {
+        minX = std::min(minX, vertexData[k]);
+        maxX = std::max(maxX, vertexData[k]);
+        minY = std::min(minY, vertexData[k + 1u]);
+        maxY = std::max(maxY, vertexData[k + 1u]);
+    }
+    minX -= margin;
+    minY -= margin;
+    maxX += margin;
+    maxY += margin;
+
+    // no lane outside of the grid
+    if (maxX < minX_ || minX > maxX_ || maxY < minY_ || minY > maxY_)
+    {
+        return;
+    }
+
+    collect(LEVEL_COUNT - 1, 0, 0, getTileX(minX), getTileY(minY), getTileX(maxX), getTileY(maxY), candidates);
+}
+
+void CoveragePyramid::collect(int32_t level,
+                              int32_t x,
+                              int32_t y,
+                              int32_t x0,
+                              int32_t y0,
+                              int32_t x1,
+                              int32_t y1,
+                              uint64_t* candidates) const
+{
+    // nothing new below this tile
+    const uint64_t* tile = getTile(level, x, y);
+    bool newLanes = false;
+    for (size_t w = 0u; w < wordCount_; ++w)
+    {
+        newLanes = newLanes || (tile[w] & ~candidates[w]) != 0u;
+    }
+    if (!newLanes)
+    {
+        return;
+    }
+
+    // tile completely inside the box: all of its lanes are candidates
+    const int32_t tileX0 = x << level;
+    const int32_t tileY0 = y << level;
+    const int32_t tileX1 = ((x + 1) << level) - 1;
+    const int32_t tileY1 = ((y + 1) << level) - 1;
+    if (level == 0 || (x0 <= tileX0 && tileX1 <= x1 && y0 <= tileY0 && tileY1 <= y1))
+    {
+        for (size_t w = 0u; w < wordCount_; ++w)
+        {
+            candidates[w] |= tile[w];
+        }
+        return;
+    }
+
+    for (int32_t k = 0; k < 4; ++k)
+    {
+        const int32_t childX = 2 * x + k % 2;
+        const int32_t childY = 2 * y + k / 2;
+        const int32_t shift = level - 1;
+        if ((childX << shift) <= x1 && (((childX + 1) << shift) - 1) >= x0 &&
+            (childY << shift) <= y1 && (((childY + 1) << shift) - 1) >= y0)
+        {
+            collect(level - 1, childX, childY, x0, y0, x1, y1, candidates);
+        }
+    }
+}
+
+int32_t CoveragePyramid::getTileX(float32_t x) const
+{
+    const float32_t tile = std::floor((x - minX_) / tileWidth_);
+    return static_cast<int32_t>(std::min(std::max(tile, 0.0f), static_cast<float32_t>(LEVEL0_SIZE - 1)));
+}
+
+int32_t CoveragePyramid::getTileY(float32_t y) const
+{
+    const float32_t tile = std::floor((y - minY_) / tileHeight_);
+    return static_cast<int32_t>(std::min(std::max(tile, 0.0f), static_cast<float32_t>(LEVEL0_SIZE - 1)));
+}
@@ -0,0 +1,63 @@
+#ifndef COVERAGE_PYRAMID_HPP
+#define COVERAGE_PYRAMID_HPP
+
+#include "QueryTypes.hpp"
+#include "LaneCache.hpp"
+
+// coarse occupancy of the lanes, for rejecting obstacle/lane pairs before they are rasterized
+// level 0 is a grid of LEVEL0_SIZE x LEVEL0_SIZE tiles over the bounding box of every lane, each tile holds
+// the set of lanes with a triangle whose bounding box touches it. Level l + 1 is the union of 2 x 2 tiles of
+// level l. A query descends from the single tile of the top level, skipping empty tiles and tiles whose lanes
+// are already candidates, so large and small boxes both visit few tiles.
+// The test is conservative: a lane which is not a candidate has no pixel in common with the box
+class CoveragePyramid
+{
+public:
+    // rebuild from the lanes of the last update of "lanes"
+    void build(const LaneCache& lanes);
+
+    // number of 64-bit words of a lane set, lane j is bit j % 64 of word j / 64
+    size_t getWordCount() const {return wordCount_;};
+
+    // set "candidates" (getWordCount() words) to the lanes which may overlap the triangles of "vertexData"
+    // (x, y, z per vertex). The bounding box of the triangles is grown by "margin" on every side
+    void query(const float32_t* vertexData, size_t floatCount, float32_t margin, uint64_t* candidates) const;
+
+    static bool contains(const uint64_t* laneSet, size_t j) {return ((laneSet[j / 64u] >> (j % 64u)) & 1u) != 0u;};
+
+private:
+    static constexpr int32_t LEVEL0_SIZE = 64;
+    static constexpr int32_t LEVEL_COUNT = 7;   // 64 x 64 down to 1 x 1
+
+    float32_t minX_{0.0f};
+    float32_t minY_{0.0f};
+    float32_t maxX_{0.0f};
+    float32_t maxY_{0.0f};
+    float32_t tileWidth_{1.0f};
+    float32_t tileHeight_{1.0f};
+    size_t wordCount_{0u};
+
+    // lane sets of every tile, level by level, row-major
+    std::vector<uint64_t> tiles_{};
+    size_t levelOffsets_[LEVEL_COUNT]{};
+
+    uint64_t* getTile(int32_t level, int32_t x, int32_t y)
+    {
+        return &tiles_[levelOffsets_[level] + (static_cast<size_t>(y) * (LEVEL0_SIZE >> level) + x) * wordCount_];
+    };
+    const uint64_t* getTile(int32_t level, int32_t x, int32_t y) const
+    {
+        return &tiles_[levelOffsets_[level] + (static_cast<size_t>(y) * (LEVEL0_SIZE >> level) + x) * wordCount_];
+    };
+
+    // level 0 tile of a world coordinate, clamped to the grid
+    int32_t getTileX(float32_t x) const;
+    int32_t getTileY(float32_t y) const;
+
+    // add the lanes of tile (x, y) of "level" which touch level 0 tiles [x0, x1] x [y0, y1]
+    void collect(int32_t level, int32_t x, int32_t y, int32_t x0, int32_t y0, int32_t x1, int32_t y1,
+                 uint64_t* candidates) const;
+
+}; // class CoveragePyramid
+
+#endif // COVERAGE_PYRAMID_HPP
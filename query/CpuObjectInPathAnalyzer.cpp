@@ -0,0 +1,469 @@
+#include "CpuObjectInPathAnalyzer.hpp"
+#include "Triangulation.hpp"
+#include <algorithm> // std::fill std::min
+
+CpuObjectInPathAnalyzer::CpuObjectInPathAnalyzer(uint32_t threadCount, const RasterConfig& config)
+    : threadPool_(threadCount)
+{
+    rasterConfig_ = config;
+    setupView(makeRasterView(config, config.roi));
+}
+
+void CpuObjectInPathAnalyzer::setupView(const RasterView& view)
+{
+    view_ = view;
+    rasterizer_.setView(view);
+
+    // a few bands per thread, so that uneven bands still keep every thread busy
+    bandCount_ = std::min(view_.height, 4u * threadPool_.getThreadCount());
+    bandHeight_ = (view_.height + bandCount_ - 1u) / bandCount_;
+
+    // the grids only grow, bands clear the part they use
+    const size_t pixelCount = static_cast<size_t>(view_.width) * view_.height;
+    if (stencil_.size() < pixelCount)
+    {
+        stencil_.resize(pixelCount);
+    }
+}
+
+void CpuObjectInPathAnalyzer::process(const std::vector<LaneView>& lanes,
+                                      const std::vector<ObstacleView>& obstacles,
+                                      std::vector<LaneAssignmentData>& result)
+{
+    setupView(makeRasterView(rasterConfig_, obstacles));
+    frameArena_.reset();
+    obstacleCache_.beginFrame();
+
+    result.resize(obstacles.size());
+    for (size_t i = 0u; i < obstacles.size(); ++i)
+    {
+        LaneAssignmentData& elem = result[i];
+        elem.obstacleId = obstacles[i].id;
+        elem.laneIds.clear();
+        elem.intersectionPixelCounts.clear();
+        elem.obstacleTotalPixelCount = 0u;
+        elem.intersectionAreas.clear();
+        elem.coverageRatios.clear();
+        elem.obstacleTotalArea = 0.0f;
+    }
+
+    // lane triangles and masks are kept while neither the lanes nor the view change
+    const size_t passCount = std::max<size_t>(1u, (lanes.size() + LANE_MASK_BITS - 1u) / LANE_MASK_BITS);
+    laneCache_.update(lanes);
+    const bool buildLaneMask = laneCache_.getRevision() != laneMaskRevision_ || view_ != laneMaskView_;
+    if (buildLaneMask)
+    {
+        laneMaskRevision_ = 0u;
+        laneTriangles_.clear();
+        laneOffsets_.assign(1u, 0u);
+        for (size_t j = 0u; j < lanes.size(); ++j)
+        {
+            const std::vector<float32_t>& laneVertexData = laneCache_.getVertexData(j);
+            rasterizer_.setup(laneVertexData.data(), laneVertexData.size() / 3u, PrimitiveMode::TRIANGLES, laneTriangles_);
+            laneOffsets_.push_back(laneTriangles_.size());
+        }
+
+        const size_t maskSize = passCount * view_.width * view_.height;
+        if (laneMask_.size() < maskSize)
+        {
+            laneMask_.resize(maskSize);
+        }
+    }
+    if (laneCache_.getRevision() != lanePyramidRevision_)
+    {
+        lanePyramid_.build(laneCache_);
+        lanePyramidRevision_ = laneCache_.getRevision();
+    }
+
+    // a margin of one pixel covers the pixel centers at the border of the tiles
+    const size_t wordCount = lanePyramid_.getWordCount();
+    laneCandidates_.resize(obstacles.size() * wordCount);
+    obstacleTriangles_.clear();
+    obstacleOffsets_.assign(1u, 0u);
+    for (size_t i = 0u; i < obstacles.size(); ++i)
+    {
+        VertexSpan obsVertexData = obstacleCache_.triangulate(obstacles[i], frameArena_);
+        result[i].obstacleVertexData.assign(obsVertexData.begin(), obsVertexData.end());
+        rasterizer_.setup(obsVertexData.data, obsVertexData.getVertexCount(), PrimitiveMode::TRIANGLES, obstacleTriangles_);
+        obstacleOffsets_.push_back(obstacleTriangles_.size());
+        lanePyramid_.query(obsVertexData.data, obsVertexData.size, view_.metresPerPixel, &laneCandidates_[i * wordCount]);
+    }
+
+    // one pass per group of LANE_MASK_BITS lanes, the first pass also counts the obstacle areas
+    for (size_t pass = 0u; pass < passCount; ++pass)
+    {
+        const size_t laneBegin = pass * LANE_MASK_BITS;
+        const size_t laneEnd = std::min(lanes.size(), laneBegin + LANE_MASK_BITS);
+        const size_t stride = 1u + (laneEnd - laneBegin);
+
+        bandCounts_.assign(bandCount_ * obstacles.size() * stride, 0u);
+
+        auto bandTask = [&](size_t band) {
+            processLaneBand(static_cast<uint32_t>(band), pass, laneBegin, laneEnd, pass == 0u, buildLaneMask);
+        };
+        threadPool_.parallelFor(bandCount_, bandTask);
+
+        // reduce the band counters
+        for (size_t i = 0u; i < obstacles.size(); ++i)
+        {
+            LaneAssignmentData& elem = result[i];
+            for (size_t k = 0u; k < stride; ++k)
+            {
+                uint32_t count = 0u;
+                for (uint32_t band = 0u; band < bandCount_; ++band)
+                {
+                    count += bandCounts_[(band * obstacles.size() + i) * stride + k];
+                }
+
+                if (k == 0u)
+                {
+                    if (pass == 0u)
+                    {
+                        elem.obstacleTotalPixelCount = count;
+                        elem.obstacleTotalArea = count * view_.getPixelArea();
+                    }
+                }
+                else if (count > 0u)
+                {
+                    // obstacle #i intersects with lane #laneId for "count" pixel
+                    elem.laneIds.push_back(lanes[laneBegin + k - 1u].id);
+                    elem.intersectionPixelCounts.push_back(count);
+                    elem.intersectionAreas.push_back(count * view_.getPixelArea());
+                    elem.coverageRatios.push_back(static_cast<float32_t>(count) / elem.obstacleTotalPixelCount);
+                }
+            }
+        }
+    }
+
+    laneMaskRevision_ = laneCache_.getRevision();
+    laneMaskView_ = view_;
+}
+
+void CpuObjectInPathAnalyzer::processLaneBand(uint32_t band,
+                                              size_t pass,
+                                              size_t laneBegin,
+                                              size_t laneEnd,
+                                              bool countTotal,
+                                              bool buildMask)
+{
+    const int32_t width = static_cast<int32_t>(view_.width);
+    const int32_t rowBegin = static_cast<int32_t>(band * bandHeight_);
+    const int32_t rowEnd = std::min(static_cast<int32_t>(view_.height), rowBegin + static_cast<int32_t>(bandHeight_));
+    if (rowBegin >= rowEnd)
+    {
+        return;
+    }
+
+    uint32_t* laneMask = &laneMask_[pass * width * view_.height];
+
+    // lane mask: every lane sets its own bit, so overlapping lanes are kept apart
+    if (buildMask)
+    {
+        std::fill(laneMask + rowBegin * width, laneMask + rowEnd * width, 0u);
+    }
+    for (size_t j = laneBegin; buildMask && j < laneEnd; ++j)
+    {
+        const uint32_t laneBit = 1u << (j - laneBegin);
+        for (size_t t = laneOffsets_[j]; t < laneOffsets_[j + 1u]; ++t)
+        {
+            const RasterTriangle& tri = laneTriangles_[t];
+            const int32_t yEnd = std::min(rowEnd, tri.rowEnd);
+            for (int32_t y = std::max(rowBegin, tri.rowBegin); y < yEnd; ++y)
+            {
+                int32_t xBegin;
+                int32_t xEnd;
+                if (CpuRasterizer::span(tri, y, xBegin, xEnd))
+                {
+                    CpuRasterizer::orSpan(&laneMask[y * width], xBegin, xEnd, laneBit);
+                }
+            }
+        }
+    }
+
+    // obstacles: every covered pixel counts once per triangle, as GL_SAMPLES_PASSED does
+    const size_t obstacleCount = obstacleOffsets_.size() - 1u;
+    const size_t stride = 1u + (laneEnd - laneBegin);
+    const size_t wordCount = lanePyramid_.getWordCount();
+    for (size_t i = 0u; i < obstacleCount; ++i)
+    {
+        // lanes of the pass which may overlap the obstacle, the pass is one half of a 64-bit word
+        const uint32_t candidates = laneEnd > laneBegin
+            ? static_cast<uint32_t>(laneCandidates_[i * wordCount + laneBegin / 64u] >> (laneBegin % 64u))
+            : 0u;
+        if (candidates == 0u && !countTotal)
+        {
+            continue;
+        }
+
+        uint32_t* counts = &bandCounts_[(band * obstacleCount + i) * stride];
+        for (size_t t = obstacleOffsets_[i]; t < obstacleOffsets_[i + 1u]; ++t)
+        {
+            const RasterTriangle& tri = obstacleTriangles_[t];
+            const int32_t yEnd = std::min(rowEnd, tri.rowEnd);
+            for (int32_t y = std::max(rowBegin, tri.rowBegin); y < yEnd; ++y)
+            {
+                int32_t xBegin;
+                int32_t xEnd;
+                if (CpuRasterizer::span(tri, y, xBegin, xEnd))
+                {
+                    if (countTotal)
+                    {
+                        counts[0] += static_cast<uint32_t>(xEnd - xBegin);
+                    }
+                    if (candidates != 0u)
+                    {
+                        CpuRasterizer::countBits(&laneMask[y * width], xBegin, xEnd, counts + 1);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void CpuObjectInPathAnalyzer::process(const FreespaceBeams& freespace,
+                                      const std::vector<ObstacleData>& obstacles,
+                                      const std::vector<ObstacleData>& querys,
+                                      std::vector<QueryCollisionData>& result)
+{
+    setupView(makeRasterView(rasterConfig_, querys));
+    frameArena_.reset();
+    obstacleCache_.beginFrame();
+    queryCache_.beginFrame();
+
+    freespaceTriangles_.clear();
+    VertexSpan fsVertexData = freespaceBuilder_.build(freespace, frameArena_);
+    rasterizer_.setup(fsVertexData.data, fsVertexData.getVertexCount(), PrimitiveMode::TRIANGLE_FAN, freespaceTriangles_);
+
+    obstacleTriangles_.clear();
+    obstacleOffsets_.assign(1u, 0u);
+    setupObstacles(obstacles, obstacleCache_, obstacleTriangles_, obstacleOffsets_);
+
+    queryTriangles_.clear();
+    queryOffsets_.assign(1u, 0u);
+    setupObstacles(querys, queryCache_, queryTriangles_, queryOffsets_);
+
+    bandCounts_.assign(bandCount_ * querys.size(), 0u);
+
+    auto bandTask = [&](size_t band) {
+        processFreespaceBand(static_cast<uint32_t>(band));
+    };
+    threadPool_.parallelFor(bandCount_, bandTask);
+
+    result.resize(querys.size());
+    for (size_t q = 0u; q < querys.size(); ++q)
+    {
+        uint32_t area = 0u;
+        for (uint32_t band = 0u; band < bandCount_; ++band)
+        {
+            area += bandCounts_[band * querys.size() + q];
+        }
+
+        QueryCollisionData& elem = result[q];
+        elem.queryId = querys[q].id;
+        elem.collisionPixelCount = area;
+        elem.collisionArea = area * view_.getPixelArea();
+        elem.collision = area > 0u;
+    }
+}
+
+void CpuObjectInPathAnalyzer::processFreespaceBand(uint32_t band)
+{
+    const int32_t width = static_cast<int32_t>(view_.width);
+    const int32_t rowBegin = static_cast<int32_t>(band * bandHeight_);
+    const int32_t rowEnd = std::min(static_cast<int32_t>(view_.height), rowBegin + static_cast<int32_t>(bandHeight_));
+    if (rowBegin >= rowEnd)
+    {
+        return;
+    }
+
+    fillFreespaceStencil(rowBegin, rowEnd);
+
+    // querys collide where they leave the freespace or hit an obstacle
+    const size_t queryCount = queryOffsets_.size() - 1u;
+    for (size_t q = 0u; q < queryCount; ++q)
+    {
+        uint32_t& count = bandCounts_[band * queryCount + q];
+        for (size_t t = queryOffsets_[q]; t < queryOffsets_[q + 1u]; ++t)
+        {
+            const RasterTriangle& tri = queryTriangles_[t];
+            const int32_t yEnd = std::min(rowEnd, tri.rowEnd);
+            for (int32_t y = std::max(rowBegin, tri.rowBegin); y < yEnd; ++y)
+            {
+                int32_t xBegin;
+                int32_t xEnd;
+                if (CpuRasterizer::span(tri, y, xBegin, xEnd))
+                {
+                    count += CpuRasterizer::countZeros(&stencil_[y * width], xBegin, xEnd);
+                }
+            }
+        }
+    }
+}
+
+void CpuObjectInPathAnalyzer::fillFreespaceStencil(int32_t rowBegin, int32_t rowEnd)
+{
+    const int32_t width = static_cast<int32_t>(view_.width);
+    std::fill(stencil_.begin() + rowBegin * width, stencil_.begin() + rowEnd * width, 0u);
+
+    auto fillTriangle = [&](const RasterTriangle& tri, uint8_t value) {
+        const int32_t yEnd = std::min(rowEnd, tri.rowEnd);
+        for (int32_t y = std::max(rowBegin, tri.rowBegin); y < yEnd; ++y)
+        {
+            int32_t xBegin;
+            int32_t xEnd;
+            if (CpuRasterizer::span(tri, y, xBegin, xEnd))
+            {
+                std::fill(&stencil_[y * width + xBegin], &stencil_[y * width + xEnd], value);
+            }
+        }
+    };
+
+    // freespace background, then obstacles cut out of it
+    for (const RasterTriangle& tri : freespaceTriangles_)
+    {
+        fillTriangle(tri, 1u);
+    }
+    for (const RasterTriangle& tri : obstacleTriangles_)
+    {
+        fillTriangle(tri, 0u);
+    }
+}
+
+void CpuObjectInPathAnalyzer::process(const FreespaceBeams& freespace,
+                                      const std::vector<ObstacleData>& obstacles,
+                                      const std::vector<TrajectoryData>& trajectories,
+                                      std::vector<TrajectoryCollisionData>& result)
+{
+    setupView(makeRasterView(rasterConfig_, trajectories));
+    frameArena_.reset();
+    obstacleCache_.beginFrame();
+    queryCache_.beginFrame();
+
+    freespaceTriangles_.clear();
+    VertexSpan fsVertexData = freespaceBuilder_.build(freespace, frameArena_);
+    rasterizer_.setup(fsVertexData.data, fsVertexData.getVertexCount(), PrimitiveMode::TRIANGLE_FAN, freespaceTriangles_);
+
+    obstacleTriangles_.clear();
+    obstacleOffsets_.assign(1u, 0u);
+    setupObstacles(obstacles, obstacleCache_, obstacleTriangles_, obstacleOffsets_);
+
+    // footprints of all trajectories one after the other, trajectory k owns poses
+    // [trajectoryOffsets_[k], trajectoryOffsets_[k + 1])
+    queryTriangles_.clear();
+    queryOffsets_.assign(1u, 0u);
+    trajectoryOffsets_.assign(1u, 0u);
+    for (const TrajectoryData& trajectory : trajectories)
+    {
+        setupObstacles(trajectory.footprints, queryCache_, queryTriangles_, queryOffsets_);
+        trajectoryOffsets_.push_back(queryOffsets_.size() - 1u);
+    }
+    const size_t poseCount = queryOffsets_.size() - 1u;
+
+    // every trajectory stamps the pixels it counted with its own value. The stamps of a call are
+    // [sweepStampBase_ + 1, sweepStampBase_ + trajectories.size()], the grid is only cleared when they wrap
+    const size_t pixelCount = static_cast<size_t>(view_.width) * view_.height;
+    if (sweepStamp_.size() < pixelCount)
+    {
+        sweepStamp_.assign(stencil_.size(), 0u);
+        sweepStampBase_ = 0u;
+    }
+    if (sweepStampBase_ > UINT32_MAX - trajectories.size())
+    {
+        std::fill(sweepStamp_.begin(), sweepStamp_.end(), 0u);
+        sweepStampBase_ = 0u;
+    }
+
+    bandCounts_.assign(bandCount_ * poseCount, 0u);
+
+    auto bandTask = [&](size_t band) {
+        processSweepBand(static_cast<uint32_t>(band));
+    };
+    threadPool_.parallelFor(bandCount_, bandTask);
+    sweepStampBase_ += static_cast<uint32_t>(trajectories.size());
+
+    result.resize(trajectories.size());
+    for (size_t k = 0u; k < trajectories.size(); ++k)
+    {
+        TrajectoryCollisionData& elem = result[k];
+        elem.trajectoryId = trajectories[k].id;
+        elem.collisionPixelCount = 0u;
+        elem.firstCollidingPose = -1;
+        for (size_t pose = trajectoryOffsets_[k]; pose < trajectoryOffsets_[k + 1u]; ++pose)
+        {
+            uint32_t area = 0u;
+            for (uint32_t band = 0u; band < bandCount_; ++band)
+            {
+                area += bandCounts_[band * poseCount + pose];
+            }
+
+            if (area > 0u && elem.firstCollidingPose < 0)
+            {
+                elem.firstCollidingPose = static_cast<int32_t>(pose - trajectoryOffsets_[k]);
+            }
+            elem.collisionPixelCount += area;
+        }
+        elem.collisionArea = elem.collisionPixelCount * view_.getPixelArea();
+        elem.collision = elem.collisionPixelCount > 0u;
+    }
+}
+
+void CpuObjectInPathAnalyzer::processSweepBand(uint32_t band)
+{
+    const int32_t width = static_cast<int32_t>(view_.width);
+    const int32_t rowBegin = static_cast<int32_t>(band * bandHeight_);
+    const int32_t rowEnd = std::min(static_cast<int32_t>(view_.height), rowBegin + static_cast<int32_t>(bandHeight_));
+    if (rowBegin >= rowEnd)
+    {
+        return;
+    }
+
+    fillFreespaceStencil(rowBegin, rowEnd);
+
+    // a colliding pixel is counted by the first pose of a trajectory which covers it, later poses skip it
+    const size_t poseCount = queryOffsets_.size() - 1u;
+    const size_t trajectoryCount = trajectoryOffsets_.size() - 1u;
+    for (size_t k = 0u; k < trajectoryCount; ++k)
+    {
+        const uint32_t stamp = sweepStampBase_ + static_cast<uint32_t>(k) + 1u;
+        for (size_t pose = trajectoryOffsets_[k]; pose < trajectoryOffsets_[k + 1u]; ++pose)
+        {
+            uint32_t& count = bandCounts_[band * poseCount + pose];
+            for (size_t t = queryOffsets_[pose]; t < queryOffsets_[pose + 1u]; ++t)
+            {
+                const RasterTriangle& tri = queryTriangles_[t];
+                const int32_t yEnd = std::min(rowEnd, tri.rowEnd);
+                for (int32_t y = std::max(rowBegin, tri.rowBegin); y < yEnd; ++y)
+                {
+                    int32_t xBegin;
+                    int32_t xEnd;
+                    if (CpuRasterizer::span(tri, y, xBegin, xEnd))
+                    {
+                        const uint8_t* stencil = &stencil_[y * width];
+                        uint32_t* stamps = &sweepStamp_[y * width];
+                        for (int32_t x = xBegin; x < xEnd; ++x)
+                        {
+                            if (stencil[x] == 0u && stamps[x] != stamp)
+                            {
+                                stamps[x] = stamp;
+                                ++count;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void CpuObjectInPathAnalyzer::setupObstacles(const std::vector<ObstacleData>& obstacles,
+                                             ObstacleCache& cache,
+                                             std::vector<RasterTriangle>& triangles,
+                                             std::vector<size_t>& offsets)
+{
+    for (const ObstacleData& obstacle : obstacles)
+    {
+        VertexSpan obsVertexData = cache.triangulate(obstacle, frameArena_);
+        rasterizer_.setup(obsVertexData.data, obsVertexData.getVertexCount(), PrimitiveMode::TRIANGLES, triangles);
+        offsets.push_back(triangles.size());
+    }
+}
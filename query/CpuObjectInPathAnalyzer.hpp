@@ -0,0 +1,126 @@
+#ifndef CPU_OBJECT_IN_PATH_ANALYZER_HPP
+#define CPU_OBJECT_IN_PATH_ANALYZER_HPP
+
+#include "ObjectInPathAnalyzerBase.hpp"
+#include "CpuRasterizer.hpp"
+#include "ThreadPool.hpp"
+#include "FrameArena.hpp"
+#include "LaneCache.hpp"
+#include "CoveragePyramid.hpp"
+#include "ObstacleCache.hpp"
+#include "FreespaceBuilder.hpp"
+
+// ObjectInPathAnalyzer backend which needs neither a GPU nor a GL context
+// the triangles are rasterized into in-memory grids with the same RasterView as the GL framebuffer,
+// so the pixel counts follow the GL_SAMPLES_PASSED results of ObjectInPathAnalyzer
+class CpuObjectInPathAnalyzer : public ObjectInPathAnalyzerBase
+{
+public:
+    // threadCount includes the calling thread. 0 means one thread per hardware core
+    explicit CpuObjectInPathAnalyzer(uint32_t threadCount = 0u, const RasterConfig& config = RasterConfig{});
+
+    using ObjectInPathAnalyzerBase::process;
+
+    // process lane assignment
+    void process(const std::vector<LaneView>& lanes,
+                 const std::vector<ObstacleView>& obstacles,
+                 std::vector<LaneAssignmentData>& result) override;
+
+    void process(const FreespaceBeams& freespace,
+                 const std::vector<ObstacleData>& obstacles,
+                 const std::vector<ObstacleData>& querys,
+                 std::vector<QueryCollisionData>& result) override;
+
+    void process(const FreespaceBeams& freespace,
+                 const std::vector<ObstacleData>& obstacles,
+                 const std::vector<TrajectoryData>& trajectories,
+                 std::vector<TrajectoryCollisionData>& result) override;
+
+private:
+    // number of lanes rasterized per pass, one bit of laneMask_ each
+    static constexpr uint32_t LANE_MASK_BITS = 32;
+
+    CpuRasterizer rasterizer_;
+    ThreadPool threadPool_;
+
+    // view of the current call, the grids have view_.width x view_.height pixels
+    RasterView view_{};
+
+    // rows are split into bands which are processed independently. Each band has its own counters
+    uint32_t bandCount_;
+    uint32_t bandHeight_;
+
+    // set the view of the current call and size the grids and bands for it
+    void setupView(const RasterView& view);
+
+    /**** grids, row-major, row 0 at the bottom as in GL ****/
+    // one grid per pass, bit j set if lane j of the pass covers the pixel
+    std::vector<uint32_t> laneMask_{};
+    // 1 inside the freespace and outside of every obstacle, 0 elsewhere
+    std::vector<uint8_t> stencil_{};
+    // trajectory sweep: stamp of the last trajectory which counted the pixel, see process()
+    std::vector<uint32_t> sweepStamp_{};
+    uint32_t sweepStampBase_{0u};
+
+    // vertex data of the current call
+    FrameArena frameArena_{};
+
+    // polygon triangulations of the previous calls
+    ObstacleCache obstacleCache_{};
+    ObstacleCache queryCache_{};
+
+    // unit directions of the freespace beams
+    FreespaceBuilder freespaceBuilder_{};
+
+    // triangulated lanes of the previous calls
+    LaneCache laneCache_{};
+    // laneTriangles_ and laneMask_ hold the lanes of this revision of laneCache_ in this view, 0 if invalid
+    uint64_t laneMaskRevision_{0u};
+    RasterView laneMaskView_{};
+
+    // coarse lane coverage of this revision of laneCache_, 0 if invalid
+    CoveragePyramid lanePyramid_{};
+    uint64_t lanePyramidRevision_{0u};
+    // lanes which may overlap obstacle #i: lanePyramid_.getWordCount() words from i * lanePyramid_.getWordCount()
+    std::vector<uint64_t> laneCandidates_{};
+
+    /**** triangles of the current call ****/
+    // triangles of element k are [offsets[k], offsets[k + 1]) of the triangle list
+    std::vector<RasterTriangle> laneTriangles_{};
+    std::vector<size_t> laneOffsets_{};
+    std::vector<RasterTriangle> obstacleTriangles_{};
+    std::vector<size_t> obstacleOffsets_{};
+    std::vector<RasterTriangle> freespaceTriangles_{};
+    std::vector<RasterTriangle> queryTriangles_{};
+    std::vector<size_t> queryOffsets_{};
+    // first footprint of every trajectory in queryOffsets_
+    std::vector<size_t> trajectoryOffsets_{};
+
+    // per band counters, reduced into the results once every band is done
+    std::vector<uint32_t> bandCounts_{};
+
+    // append the triangles of every element to "triangles" and record where each element starts
+    void setupObstacles(const std::vector<ObstacleData>& obstacles,
+                        ObstacleCache& cache,
+                        std::vector<RasterTriangle>& triangles,
+                        std::vector<size_t>& offsets);
+
+    // count the coverage of every obstacle by lanes [laneBegin, laneEnd) in rows of "band"
+    // lanes which are not in laneCandidates_ of an obstacle are not counted, obstacles without any are skipped
+    // the lane mask of "pass" is rasterized first if "buildMask" is set, otherwise the cached one is used
+    // counters of obstacle i: [total pixel count, pixel count of lane laneBegin, ...]
+    void processLaneBand(uint32_t band, size_t pass, size_t laneBegin, size_t laneEnd, bool countTotal, bool buildMask);
+
+    // rasterize the freespace minus the obstacles and count the colliding pixels of every query in rows of "band"
+    void processFreespaceBand(uint32_t band);
+
+    // rasterize the freespace minus the obstacles and count the colliding pixels of every footprint in rows
+    // of "band", skipping the pixels an earlier footprint of the same trajectory already counted
+    void processSweepBand(uint32_t band);
+
+    // fill stencil_ in rows [rowBegin, rowEnd)
+    void fillFreespaceStencil(int32_t rowBegin, int32_t rowEnd);
+
+}; // class CpuObjectInPathAnalyzer
+
+#endif // CPU_OBJECT_IN_PATH_ANALYZER_HPP
@@ -0,0 +1,360 @@
+#include "CpuRasterizer.hpp"
+#include <algorithm> // std::min std::max
+#include <cmath> // std::llround
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CPU_RASTERIZER_SSE2 1
+#endif
+
+namespace
+{
+
+// floor(n / d) for d > 0
+int64_t floorDiv(int64_t n, int64_t d)
+{
+    int64_t q = n / d;
+    if ((n % d != 0) && (n < 0))
+    {
+        --q;
+    }
+    return q;
+}
+
+// ceil(n / d) for d > 0
+int64_t ceilDiv(int64_t n, int64_t d)
+{
+    return -floorDiv(-n, d);
+}
+
+uint32_t countTrailingZeros(uint32_t v)
+{
+#if defined(__GNUC__)
+    return static_cast<uint32_t>(__builtin_ctz(v));
+#else
+    uint32_t n = 0u;
+    while ((v & 1u) == 0u)
+    {
+        v >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+uint32_t popCount(uint32_t v)
+{
+#if defined(__GNUC__)
+    return static_cast<uint32_t>(__builtin_popcount(v));
+#else
+    uint32_t n = 0u;
+    for (; v != 0u; v &= v - 1u)
+    {
+        ++n;
+    }
+    return n;
+#endif
+}
+
+constexpr int64_t SUBPIXEL_ONE = int64_t(1) << CpuRasterizer::SUBPIXEL_BITS;
+constexpr int64_t SUBPIXEL_HALF = SUBPIXEL_ONE / 2;
+
+} // namespace
+
+CpuRasterizer::CpuRasterizer(const RasterView& view)
+{
+    setView(view);
+}
+
+void CpuRasterizer::setView(const RasterView& view)
+{
+    width_ = view.width;
+    height_ = view.height;
+    scaleX_ = view.getScaleX();
+    scaleY_ = view.getScaleY();
+    offsetX_ = view.getOffsetX();
+    offsetY_ = view.getOffsetY();
+}
+
+void CpuRasterizer::setup(const float32_t* vertexData,
+                          size_t vertexCount,
+                          PrimitiveMode mode,
+                          std::vector<RasterTriangle>& triangles) const
+{
+    if (vertexCount < 3u)
+    {
+        return;
+    }
+
+    size_t triangleCount = 0u;
+    switch (mode)
+    {
+    case PrimitiveMode::TRIANGLES:
+        triangleCount = vertexCount / 3u;
+        break;
+    case PrimitiveMode::TRIANGLE_STRIP:
+    case PrimitiveMode::TRIANGLE_FAN:
+        triangleCount = vertexCount - 2u;
+        break;
+    }
+
+    // same viewport transform as GL: window = (ndc + 1) / 2 * size
+    const float32_t halfWidth = 0.5f * static_cast<float32_t>(width_);
+    const float32_t halfHeight = 0.5f * static_cast<float32_t>(height_);
+
+    // triangles reaching beyond the guard band are clipped, which keeps the edge functions in int64 range
+    const float32_t guard = static_cast<float32_t>(std::max(width_, height_));
+    const float32_t clipMinX = -guard;
+    const float32_t clipMinY = -guard;
+    const float32_t clipMaxX = static_cast<float32_t>(width_) + guard;
+    const float32_t clipMaxY = static_cast<float32_t>(height_) + guard;
+
+    for (size_t t = 0u; t < triangleCount; ++t)
+    {
+        size_t index[3];
+        switch (mode)
+        {
+        case PrimitiveMode::TRIANGLES:
+            index[0] = 3u * t;
+            index[1] = 3u * t + 1u;
+            index[2] = 3u * t + 2u;
+            break;
+        case PrimitiveMode::TRIANGLE_STRIP:
+            index[0] = t;
+            index[1] = t + 1u;
+            index[2] = t + 2u;
+            break;
+        case PrimitiveMode::TRIANGLE_FAN:
+            index[0] = 0u;
+            index[1] = t + 1u;
+            index[2] = t + 2u;
+            break;
+        }
+
+        float32_t x[3];
+        float32_t y[3];
+        bool insideGuardBand = true;
+        for (size_t k = 0u; k < 3u; ++k)
+        {
+            x[k] = (vertexData[3u * index[k]] * scaleX_ + offsetX_) * halfWidth + halfWidth;
+            y[k] = (vertexData[3u * index[k] + 1u] * scaleY_ + offsetY_) * halfHeight + halfHeight;
+            insideGuardBand = insideGuardBand &&
+                              x[k] >= clipMinX && x[k] <= clipMaxX && y[k] >= clipMinY && y[k] <= clipMaxY;
+        }
+
+        if (insideGuardBand)
+        {
+            setupTriangle(x, y, triangles);
+            continue;
+        }
+
+        // trivially reject triangles entirely on one side of the grid
+        if (std::max({x[0], x[1], x[2]}) < 0.0f || std::min({x[0], x[1], x[2]}) > static_cast<float32_t>(width_) ||
+            std::max({y[0], y[1], y[2]}) < 0.0f || std::min({y[0], y[1], y[2]}) > static_cast<float32_t>(height_))
+        {
+            continue;
+        }
+
+        // Sutherland-Hodgman against the 4 guard band planes, then fan the clipped polygon
+        float32_t polygon[2][2][9];
+        size_t size = 3u;
+        std::copy(x, x + 3, polygon[0][0]);
+        std::copy(y, y + 3, polygon[0][1]);
+
+        const float32_t planes[4] = {clipMinX, clipMaxX, clipMinY, clipMaxY};
+        for (size_t p = 0u; p < 4u && size > 0u; ++p)
+        {
+            const float32_t* inX = polygon[p % 2u][0];
+            const float32_t* inY = polygon[p % 2u][1];
+            float32_t* outX = polygon[(p + 1u) % 2u][0];
+            float32_t* outY = polygon[(p + 1u) % 2u][1];
+            const bool vertical = p < 2u;         // plane x = const
+            const float32_t sign = (p % 2u == 0u) ? 1.0f : -1.0f; // min planes keep the larger side
+
+            size_t outSize = 0u;
+            for (size_t k = 0u; k < size; ++k)
+            {
+                size_t next = (k + 1u) % size;
+                float32_t d0 = sign * ((vertical ? inX[k] : inY[k]) - planes[p]);
+                float32_t d1 = sign * ((vertical ? inX[next] : inY[next]) - planes[p]);
+                if (d0 >= 0.0f)
+                {
+                    outX[outSize] = inX[k];
+                    outY[outSize] = inY[k];
+                    ++outSize;
+                }
+                if ((d0 >= 0.0f) != (d1 >= 0.0f))
+                {
+                    float32_t s = d0 / (d0 - d1);
+                    outX[outSize] = inX[k] + s * (inX[next] - inX[k]);
+                    outY[outSize] = inY[k] + s * (inY[next] - inY[k]);
+                    ++outSize;
+                }
+            }
+            size = outSize;
+        }
+
+        const float32_t* clippedX = polygon[0][0];
+        const float32_t* clippedY = polygon[0][1];
+        for (size_t k = 1u; k + 1u < size; ++k)
+        {
+            float32_t fanX[3] = {clippedX[0], clippedX[k], clippedX[k + 1u]};
+            float32_t fanY[3] = {clippedY[0], clippedY[k], clippedY[k + 1u]};
+            setupTriangle(fanX, fanY, triangles);
+        }
+    }
+}
+
+void CpuRasterizer::setupTriangle(const float32_t* x, const float32_t* y, std::vector<RasterTriangle>& triangles) const
+{
+    int64_t X[3];
+    int64_t Y[3];
+    for (size_t k = 0u; k < 3u; ++k)
+    {
+        X[k] = std::llround(x[k] * static_cast<float32_t>(SUBPIXEL_ONE));
+        Y[k] = std::llround(y[k] * static_cast<float32_t>(SUBPIXEL_ONE));
+    }
+
+    // make the triangle counter-clockwise (window y axis points up), drop degenerate ones
+    int64_t area = (X[1] - X[0]) * (Y[2] - Y[0]) - (X[2] - X[0]) * (Y[1] - Y[0]);
+    if (area == 0)
+    {
+        return;
+    }
+    if (area < 0)
+    {
+        std::swap(X[1], X[2]);
+        std::swap(Y[1], Y[2]);
+    }
+
+    RasterTriangle tri;
+
+    // pixel (i, j) has its center at ((i + 0.5), (j + 0.5)), so it is inside the bounding box if
+    // min <= i * ONE + HALF <= max
+    int64_t minX = std::min({X[0], X[1], X[2]});
+    int64_t maxX = std::max({X[0], X[1], X[2]});
+    int64_t minY = std::min({Y[0], Y[1], Y[2]});
+    int64_t maxY = std::max({Y[0], Y[1], Y[2]});
+    tri.colBegin = static_cast<int32_t>(std::max<int64_t>(0, ceilDiv(minX - SUBPIXEL_HALF, SUBPIXEL_ONE)));
+    tri.colEnd = static_cast<int32_t>(std::min<int64_t>(width_, floorDiv(maxX - SUBPIXEL_HALF, SUBPIXEL_ONE) + 1));
+    tri.rowBegin = static_cast<int32_t>(std::max<int64_t>(0, ceilDiv(minY - SUBPIXEL_HALF, SUBPIXEL_ONE)));
+    tri.rowEnd = static_cast<int32_t>(std::min<int64_t>(height_, floorDiv(maxY - SUBPIXEL_HALF, SUBPIXEL_ONE) + 1));
+    if (tri.colBegin >= tri.colEnd || tri.rowBegin >= tri.rowEnd)
+    {
+        return;
+    }
+
+    for (size_t k = 0u; k < 3u; ++k)
+    {
+        size_t next = (k + 1u) % 3u;
+        int64_t dx = X[next] - X[k];
+        int64_t dy = Y[next] - Y[k];
+
+        // the interior is on the left of each edge
+        tri.a[k] = -dy;
+        tri.b[k] = dx;
+        tri.c[k] = dy * X[k] - dx * Y[k];
+
+        // left edges (going down) and top edges (horizontal, going left) own their pixels
+        bool owner = (dy < 0) || (dy == 0 && dx < 0);
+        tri.bias[k] = owner ? 0 : 1;
+    }
+
+    triangles.push_back(tri);
+}
+
+bool CpuRasterizer::span(const RasterTriangle& tri, int32_t y, int32_t& xBegin, int32_t& xEnd)
+{
+    int64_t begin = tri.colBegin;
+    int64_t end = tri.colEnd;
+    const int64_t py = static_cast<int64_t>(y) * SUBPIXEL_ONE + SUBPIXEL_HALF;
+
+    for (size_t k = 0u; k < 3u; ++k)
+    {
+        // E(x) = a * (x * ONE + HALF) + k0 >= bias
+        const int64_t a = tri.a[k];
+        const int64_t k0 = tri.b[k] * py + tri.c[k];
+
+        if (a > 0)
+        {
+            begin = std::max(begin, ceilDiv(tri.bias[k] - k0 - a * SUBPIXEL_HALF, a * SUBPIXEL_ONE));
+        }
+        else if (a < 0)
+        {
+            end = std::min(end, floorDiv(k0 + a * SUBPIXEL_HALF - tri.bias[k], -a * SUBPIXEL_ONE) + 1);
+        }
+        else if (k0 < tri.bias[k])
+        {
+            return false;
+        }
+    }
+
+    xBegin = static_cast<int32_t>(begin);
+    xEnd = static_cast<int32_t>(end);
+    return begin < end;
+}
+
+void CpuRasterizer::orSpan(uint32_t* row, int32_t xBegin, int32_t xEnd, uint32_t bits)
+{
+    int32_t x = xBegin;
+#if defined(CPU_RASTERIZER_SSE2)
+    const __m128i vbits = _mm_set1_epi32(static_cast<int32_t>(bits));
+    for (; x + 4 <= xEnd; x += 4)
+    {
+        __m128i* p = reinterpret_cast<__m128i*>(row + x);
+        _mm_storeu_si128(p, _mm_or_si128(_mm_loadu_si128(p), vbits));
+    }
+#endif
+    for (; x < xEnd; ++x)
+    {
+        row[x] |= bits;
+    }
+}
+
+void CpuRasterizer::countBits(const uint32_t* row, int32_t xBegin, int32_t xEnd, uint32_t* counts)
+{
+    // lane masks are piecewise constant along a row: count runs of equal masks, then add each run once
+    int32_t x = xBegin;
+    while (x < xEnd)
+    {
+        uint32_t mask = row[x];
+        int32_t runBegin = x++;
+#if defined(CPU_RASTERIZER_SSE2)
+        const __m128i vmask = _mm_set1_epi32(static_cast<int32_t>(mask));
+        while (x + 4 <= xEnd &&
+               _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x)), vmask)) == 0xFFFF)
+        {
+            x += 4;
+        }
+#endif
+        while (x < xEnd && row[x] == mask)
+        {
+            ++x;
+        }
+
+        const uint32_t runLength = static_cast<uint32_t>(x - runBegin);
+        for (; mask != 0u; mask &= mask - 1u)
+        {
+            counts[countTrailingZeros(mask)] += runLength;
+        }
+    }
+}
+
+uint32_t CpuRasterizer::countZeros(const uint8_t* row, int32_t xBegin, int32_t xEnd)
+{
+    uint32_t count = 0u;
+    int32_t x = xBegin;
+#if defined(CPU_RASTERIZER_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; x + 16 <= xEnd; x += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x));
+        count += popCount(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero))));
+    }
+#endif
+    for (; x < xEnd; ++x)
+    {
+        count += (row[x] == 0u) ? 1u : 0u;
+    }
+    return count;
+}
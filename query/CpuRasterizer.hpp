@@ -0,0 +1,84 @@
+#ifndef CPU_RASTERIZER_HPP
+#define CPU_RASTERIZER_HPP
+
+// scanline rasterizer producing the same pixel coverage as the GL pipeline of ObjectInPathAnalyzer:
+// vertices are snapped to a sub-pixel grid, pixel centers are tested against exact integer edge
+// functions and shared edges are owned by one triangle only (top-left rule)
+
+#include "QueryTypes.hpp"
+#include "RasterView.hpp"
+
+// vertex layout of the vertex data, same meaning as GL_TRIANGLES / GL_TRIANGLE_STRIP / GL_TRIANGLE_FAN
+enum class PrimitiveMode
+{
+    TRIANGLES,
+    TRIANGLE_STRIP,
+    TRIANGLE_FAN
+};
+
+// triangle in sub-pixel window coordinates, ready for scan conversion
+struct RasterTriangle
+{
+    // edge functions E(x, y) = a * x + b * y + c, a pixel center is covered if E >= bias for all 3 edges
+    int64_t a[3];
+    int64_t b[3];
+    int64_t c[3];
+    int64_t bias[3];    // 0 if the edge owns the pixel centers lying on it, 1 otherwise
+
+    // bounding box in pixels, clamped to the grid. [rowBegin, rowEnd) x [colBegin, colEnd)
+    int32_t rowBegin;
+    int32_t rowEnd;
+    int32_t colBegin;
+    int32_t colEnd;
+};
+
+class CpuRasterizer
+{
+public:
+    explicit CpuRasterizer(const RasterView& view = RasterView{});
+
+    // grid size and world mapping of the following setup() calls
+    void setView(const RasterView& view);
+
+    uint32_t getWidth() const {return width_;};
+    uint32_t getHeight() const {return height_;};
+
+    // assemble the triangles of vertexData (x, y, z per vertex), clip them to the guard band
+    // and append the ones which can cover a pixel to "triangles"
+    void setup(const float32_t* vertexData,
+               size_t vertexCount,
+               PrimitiveMode mode,
+               std::vector<RasterTriangle>& triangles) const;
+
+    // pixels [xBegin, xEnd) of row y covered by the triangle. Returns false if there is none
+    static bool span(const RasterTriangle& tri, int32_t y, int32_t& xBegin, int32_t& xEnd);
+
+    /**** span kernels ****/
+    // row[x] |= bits for x in [xBegin, xEnd)
+    static void orSpan(uint32_t* row, int32_t xBegin, int32_t xEnd, uint32_t bits);
+
+    // for every bit j set in row[x], x in [xBegin, xEnd): ++counts[j]
+    static void countBits(const uint32_t* row, int32_t xBegin, int32_t xEnd, uint32_t* counts);
+
+    // number of x in [xBegin, xEnd) with row[x] == 0
+    static uint32_t countZeros(const uint8_t* row, int32_t xBegin, int32_t xEnd);
+
+    // number of sub-pixel steps per pixel is 1 << SUBPIXEL_BITS, as in common GL implementations
+    static constexpr int32_t SUBPIXEL_BITS = 8;
+
+private:
+    uint32_t width_;
+    uint32_t height_;
+
+    // world to normalized device coordinates, as the view transform of SimpleVertexShader
+    float32_t scaleX_;
+    float32_t scaleY_;
+    float32_t offsetX_;
+    float32_t offsetY_;
+
+    // snap a triangle in pixel coordinates and append it, unless it is degenerate or off-grid
+    void setupTriangle(const float32_t* x, const float32_t* y, std::vector<RasterTriangle>& triangles) const;
+
+}; // class CpuRasterizer
+
+#endif // CPU_RASTERIZER_HPP
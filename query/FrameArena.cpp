@@ -0,0 +1,38 @@
+#include "FrameArena.hpp"
+
+FrameArena::FrameArena(size_t initialFloatCount)
+    : block_(new float32_t[initialFloatCount])
+    , capacity_(initialFloatCount)
+{
+}
+
+VertexSpan FrameArena::allocate(size_t floatCount)
+{
+    VertexSpan span{};
+    span.size = floatCount;
+
+    if (used_ + floatCount <= capacity_)
+    {
+        span.data = block_.get() + used_;
+        used_ += floatCount;
+        return span;
+    }
+
+    // spans handed out earlier in the frame stay valid, so block_ cannot be reallocated here
+    overflow_.emplace_back(new float32_t[floatCount]);
+    overflowSize_ += floatCount;
+    span.data = overflow_.back().get();
+    return span;
+}
+
+void FrameArena::reset()
+{
+    if (!overflow_.empty())
+    {
+        capacity_ = used_ + overflowSize_;
+        block_.reset(new float32_t[capacity_]);
+        overflow_.clear();
+        overflowSize_ = 0u;
+    }
+    used_ = 0u;
+}
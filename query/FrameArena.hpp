@@ -0,0 +1,51 @@
+#ifndef FRAME_ARENA_HPP
+#define FRAME_ARENA_HPP
+
+#include "QueryTypes.hpp"
+#include <memory>
+
+// contiguous floats owned by a FrameArena, valid until the next reset() of the arena
+struct VertexSpan
+{
+    float32_t* data{nullptr};
+    size_t size{0u};    // floats, 3 per vertex
+
+    size_t getVertexCount() const {return size / 3u;};
+
+    float32_t* begin() const {return data;};
+    float32_t* end() const {return data + size;};
+};
+
+// frame scoped bump allocator for the vertex data of the triangulations
+// allocate() hands out consecutive parts of one block and reset() releases all of them at once.
+// A frame which does not fit falls back to extra blocks; the next reset() merges them into a single
+// block of the combined size, so the arena stops allocating once it has seen the largest frame
+class FrameArena
+{
+public:
+    explicit FrameArena(size_t initialFloatCount = 16384u);
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // "floatCount" uninitialized floats
+    VertexSpan allocate(size_t floatCount);
+
+    // release every span of the current frame
+    void reset();
+
+    // floats available without allocating
+    size_t getCapacity() const {return capacity_;};
+
+private:
+    std::unique_ptr<float32_t[]> block_{};
+    size_t capacity_;
+    size_t used_{0u};
+
+    // blocks of a frame which outgrew block_, released by reset()
+    std::vector<std::unique_ptr<float32_t[]>> overflow_{};
+    size_t overflowSize_{0u};
+
+}; // class FrameArena
+
+#endif // FRAME_ARENA_HPP
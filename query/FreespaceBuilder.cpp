@@ -0,0 +1,128 @@
+#include "FreespaceBuilder.hpp"
+#include <cmath> // std::sin std::cos
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+
+// x, y, z = 0 of "count" beams starting at "first"
+void writeBeams(const float32_t* cosTable,
+                const float32_t* sinTable,
+                const float32_t* ranges,
+                size_t first,
+                size_t count,
+                float32_t* out)
+{
+    for (size_t i = first; i < count; ++i)
+    {
+        out[3u * i] = cosTable[i] * ranges[i];
+        out[3u * i + 1u] = sinTable[i] * ranges[i];
+        out[3u * i + 2u] = 0.0f;
+    }
+}
+
+} // namespace
+
+VertexSpan FreespaceBuilder::build(const FreespaceBeams& beams, FrameArena& arena)
+{
+    if (!matchesLayout(beams))
+    {
+        setLayout(beams);
+    }
+
+    const float32_t* ranges = beams.ranges;
+    if (beams.rangeStride != 1u && beams.count > 0u)
+    {
+        ranges_.resize(beams.count);
+        for (size_t i = 0u; i < beams.count; ++i)
+        {
+            ranges_[i] = beams.ranges[i * beams.rangeStride];
+        }
+        ranges = ranges_.data();
+    }
+
+    // output GL_TRIANGLE_FAN layout
+    // Indices:     0 1 2 3 4 5 ...
+    // Triangles:  {0 1 2}
+    //             {0} {2 3}
+    //             {0}   {3 4}
+    //             {0}     {4 5}
+    VertexSpan ret = arena.allocate((1u + beams.count) * 3u);
+    ret.data[0] = 0.0f;
+    ret.data[1] = 0.0f;
+    ret.data[2] = 0.0f;
+    float32_t* out = ret.data + 3;
+
+    size_t i = 0u;
+#if defined(__SSE2__)
+    // 4 beams are 12 floats, i.e. 3 stores of x0 y0 0 x1 | y1 0 x2 y2 | 0 x3 y3 0
+    const __m128 mask0 = _mm_castsi128_ps(_mm_set_epi32(-1, 0, -1, -1));
+    const __m128 mask1 = _mm_castsi128_ps(_mm_set_epi32(-1, -1, 0, -1));
+    const __m128 mask2 = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, 0));
+    for (; i + 4u <= beams.count; i += 4u)
+    {
+        const __m128 range = _mm_loadu_ps(ranges + i);
+        const __m128 x = _mm_mul_ps(_mm_loadu_ps(&cos_[i]), range);
+        const __m128 y = _mm_mul_ps(_mm_loadu_ps(&sin_[i]), range);
+
+        const __m128 xyLow = _mm_unpacklo_ps(x, y);     // x0 y0 x1 y1
+        const __m128 xyHigh = _mm_unpackhi_ps(x, y);    // x2 y2 x3 y3
+        float32_t* dst = out + 3u * i;
+        _mm_storeu_ps(dst, _mm_and_ps(_mm_shuffle_ps(xyLow, xyLow, _MM_SHUFFLE(2, 0, 1, 0)), mask0));
+        _mm_storeu_ps(dst + 4, _mm_and_ps(_mm_shuffle_ps(xyLow, xyHigh, _MM_SHUFFLE(1, 0, 3, 3)), mask1));
+        _mm_storeu_ps(dst + 8, _mm_and_ps(_mm_shuffle_ps(xyHigh, xyHigh, _MM_SHUFFLE(0, 3, 2, 0)), mask2));
+    }
+#endif
+    writeBeams(cos_.data(), sin_.data(), ranges, i, beams.count, out);
+
+    return ret;
+}
+
+bool FreespaceBuilder::matchesLayout(const FreespaceBeams& beams) const
+{
+    if (beams.count != angles_.size())
+    {
+        return false;
+    }
+    for (size_t i = 0u; i < beams.count; ++i)
+    {
+        if (beams.angles[i * beams.angleStride] != angles_[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void FreespaceBuilder::setLayout(const FreespaceBeams& beams)
+{
+    angles_.resize(beams.count);
+    cos_.resize(beams.count);
+    sin_.resize(beams.count);
+    for (size_t i = 0u; i < beams.count; ++i)
+    {
+        angles_[i] = beams.angles[i * beams.angleStride];
+        cos_[i] = std::cos(angles_[i]);
+        sin_[i] = std::sin(angles_[i]);
+    }
+    ++layoutCount_;
+}
+
+FreespaceBeams makeFreespaceBeams(const FreespaceData& fs)
+{
+    static_assert(sizeof(std::pair<float32_t, float32_t>) == 2u * sizeof(float32_t),
+                  "FreespaceData pairs are read as interleaved angle/range floats");
+
+    FreespaceBeams beams{};
+    beams.count = fs.data.size();
+    if (beams.count > 0u)
+    {
+        beams.angles = &fs.data[0].first;
+        beams.ranges = &fs.data[0].second;
+        beams.angleStride = 2u;
+        beams.rangeStride = 2u;
+    }
+    return beams;
+}
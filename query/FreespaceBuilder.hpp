@@ -0,0 +1,39 @@
+#ifndef FREESPACE_BUILDER_HPP
+#define FREESPACE_BUILDER_HPP
+
+#include "QueryTypes.hpp"
+#include "FrameArena.hpp"
+
+// freespace triangulation for sensors with a fixed beam layout
+// the unit directions of the beams are computed once per layout and kept as separate cos/sin arrays,
+// so a frame only multiplies them with the ranges, 4 beams at a time with SSE2.
+// The layout is compared with the previous one on every call, a changed layout is recomputed
+class FreespaceBuilder
+{
+public:
+    // output GL_TRIANGLE_FAN layout around the origin, then one vertex per beam
+    VertexSpan build(const FreespaceBeams& beams, FrameArena& arena);
+
+    // number of layouts computed so far
+    size_t getLayoutCount() const {return layoutCount_;};
+
+private:
+    /**** layout, structure of arrays ****/
+    std::vector<float32_t> angles_{};
+    std::vector<float32_t> cos_{};
+    std::vector<float32_t> sin_{};
+    size_t layoutCount_{0u};
+
+    // contiguous copy of strided ranges
+    std::vector<float32_t> ranges_{};
+
+    bool matchesLayout(const FreespaceBeams& beams) const;
+
+    void setLayout(const FreespaceBeams& beams);
+
+}; // class FreespaceBuilder
+
+// beams which read "fs" in place
+FreespaceBeams makeFreespaceBeams(const FreespaceData& fs);
+
+#endif // FREESPACE_BUILDER_HPP
@@ -0,0 +1,36 @@
+#ifndef GEOMETRY_HASH_HPP
+#define GEOMETRY_HASH_HPP
+
+// content hashes of input geometry, used to detect unchanged elements between calls
+
+#include "InputView.hpp"
+
+// FNV-1a
+constexpr uint64_t GEOMETRY_HASH_SEED = 14695981039346656037ull;
+
+inline uint64_t hashBytes(uint64_t h, const void* data, size_t size)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0u; i < size; ++i)
+    {
+        h = (h ^ bytes[i]) * 1099511628211ull;
+    }
+    return h;
+}
+
+// the size is hashed too, so that neighbouring point lists cannot shift into each other
+// x, y, z of each point, which hashes a std::vector<Point3f> like its bytes
+inline uint64_t hashPoints(uint64_t h, const PointArray& points)
+{
+    const uint64_t size = points.size();
+    h = hashBytes(h, &size, sizeof(size));
+    for (size_t i = 0u; i < points.size(); ++i)
+    {
+        const Point3f p = points[i];
+        const float32_t xyz[3] = {p.x, p.y, p.z};
+        h = hashBytes(h, xyz, sizeof(xyz));
+    }
+    return h;
+}
+
+#endif // GEOMETRY_HASH_HPP
@@ -0,0 +1,113 @@
+#ifndef INPUT_VIEW_HPP
+#define INPUT_VIEW_HPP
+
+// read-only views of the input geometry, so that the analyzers read the points where they already are:
+// in the std::vector members of LaneData and ObstacleData, or in the point arrays of a shared memory frame.
+// A view does not own anything, the viewed memory has to outlive it
+
+#include "QueryTypes.hpp"
+
+static_assert(sizeof(Point3f) == 3u * sizeof(float32_t), "Point3f arrays are viewed as strided floats");
+
+// point i is (x[i * stride], y[i * stride], z[i * stride]), z is 0 if there is no z array
+struct PointArray
+{
+    const float32_t* x{nullptr};
+    const float32_t* y{nullptr};
+    const float32_t* z{nullptr};
+    size_t count{0u};
+    size_t stride{1u};  // in floats
+
+    size_t size() const {return count;};
+    bool empty() const {return count == 0u;};
+
+    Point3f operator[](size_t i) const
+    {
+        return Point3f{x[i * stride], y[i * stride], z != nullptr ? z[i * stride] : 0.0f};
+    };
+};
+
+struct LaneView
+{
+    PointArray leftDiv{};
+    PointArray rightDiv{};  // assume left and right dividers have the same size
+    uint32_t id{0u};
+};
+
+struct ObstacleView
+{
+    PointArray boundaryPoints{};
+    ObstacleShape shape{ObstacleShape::QUAD};
+    uint32_t id{0u};
+
+    // holes are either viewed arrays or the vectors of an ObstacleData, so that viewing an ObstacleData
+    // needs no storage
+    size_t holeCount{0u};
+    const PointArray* holeArrays{nullptr};
+    const std::vector<Point3f>* holeVectors{nullptr};
+
+    PointArray getHole(size_t k) const;
+};
+
+inline PointArray makePointArray(const std::vector<Point3f>& points)
+{
+    PointArray view{};
+    if (!points.empty())
+    {
+        view.x = &points[0].x;
+        view.y = &points[0].y;
+        view.z = &points[0].z;
+    }
+    view.count = points.size();
+    view.stride = 3u;
+
+    return view;
+}
+
+inline PointArray ObstacleView::getHole(size_t k) const
+{
+    return holeArrays != nullptr ? holeArrays[k] : makePointArray(holeVectors[k]);
+}
+
+inline LaneView makeLaneView(const LaneData& lane)
+{
+    LaneView view{};
+    view.leftDiv = makePointArray(lane.leftDiv);
+    view.rightDiv = makePointArray(lane.rightDiv);
+    view.id = lane.id;
+
+    return view;
+}
+
+inline ObstacleView makeObstacleView(const ObstacleData& obs)
+{
+    ObstacleView view{};
+    view.boundaryPoints = makePointArray(obs.boundaryPoints);
+    view.shape = obs.shape;
+    view.id = obs.id;
+    view.holeCount = obs.holes.size();
+    view.holeVectors = obs.holes.data();
+
+    return view;
+}
+
+// views of every element, "views" is refilled in place
+inline void makeLaneViews(const std::vector<LaneData>& lanes, std::vector<LaneView>& views)
+{
+    views.clear();
+    for (const LaneData& lane : lanes)
+    {
+        views.push_back(makeLaneView(lane));
+    }
+}
+
+inline void makeObstacleViews(const std::vector<ObstacleData>& obstacles, std::vector<ObstacleView>& views)
+{
+    views.clear();
+    for (const ObstacleData& obs : obstacles)
+    {
+        views.push_back(makeObstacleView(obs));
+    }
+}
+
+#endif // INPUT_VIEW_HPP
@@ -0,0 +1,106 @@
+#include "LaneCache.hpp"
+#include "Triangulation.hpp"
+#include "GeometryHash.hpp"
+
+uint64_t LaneCache::hash(const LaneView& lane)
+{
+    return hashPoints(hashPoints(GEOMETRY_HASH_SEED, lane.leftDiv), lane.rightDiv);
+}
+
+bool LaneCache::update(const std::vector<LaneData>& lanes)
+{
+    makeLaneViews(lanes, views_);
+    return update(views_);
+}
+
+bool LaneCache::update(const std::vector<LaneView>& lanes)
+{
+    ++updateCount_;
+    rebuildCount_ = 0u;
+    arena_.reset();
+
+    std::swap(order_, previousOrder_);
+    order_.clear();
+    bool changed = updateCount_ == 1u || lanes.size() != previousOrder_.size();
+
+    try
+    {
+        matchLanes(lanes, changed);
+    }
+    catch (...)
+    {
+        // invalid lane data: forget everything, so that no partial state is reused
+        entries_.clear();
+        freeEntries_.clear();
+        entryOfId_.clear();
+        order_.clear();
+        previousOrder_.clear();
+        ++revision_;
+        throw;
+    }
+
+    if (changed)
+    {
+        ++revision_;
+    }
+    return changed;
+}
+
+void LaneCache::matchLanes(const std::vector<LaneView>& lanes, bool& changed)
+{
+    for (size_t j = 0u; j < lanes.size(); ++j)
+    {
+        const LaneView& lane = lanes[j];
+        const uint64_t laneHash = hash(lane);
+
+        size_t index;
+        auto it = entryOfId_.find(lane.id);
+        if (it != entryOfId_.end())
+        {
+            index = it->second;
+        }
+        else
+        {
+            if (freeEntries_.empty())
+            {
+                index = entries_.size();
+                entries_.emplace_back();
+            }
+            else
+            {
+                index = freeEntries_.back();
+                freeEntries_.pop_back();
+            }
+            entryOfId_[lane.id] = index;
+            entries_[index].id = lane.id;
+            entries_[index].vertexData.clear();
+            entries_[index].hash = ~laneHash;   // force the triangulation below
+        }
+
+        Entry& entry = entries_[index];
+        if (entry.hash != laneHash)
+        {
+            VertexSpan vertexData = trivialLaneTriangulation(lane, arena_);
+            entry.vertexData.assign(vertexData.begin(), vertexData.end());
+            entry.hash = laneHash;
+            ++rebuildCount_;
+            changed = true;
+        }
+        entry.lastUpdate = updateCount_;
+
+        changed = changed || previousOrder_[j] != index;   // sizes match if not changed yet
+        order_.push_back(index);
+    }
+
+    // drop the lanes which are gone
+    for (size_t index : previousOrder_)
+    {
+        Entry& entry = entries_[index];
+        if (entry.lastUpdate != updateCount_ && entry.lastUpdate != 0u)
+        {
+            entryOfId_.erase(entry.id);
+            entry.lastUpdate = 0u;
+            freeEntries_.push_back(index);
+        }
+    }
+}
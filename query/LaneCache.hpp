@@ -0,0 +1,64 @@
+#ifndef LANE_CACHE_HPP
+#define LANE_CACHE_HPP
+
+#include "InputView.hpp"
+#include "FrameArena.hpp"
+#include <unordered_map>
+
+// triangulated lanes kept across calls, keyed by LaneData::id
+// a lane is only re-triangulated if its id is new or the hash of its dividers changed.
+// Lanes which are missing from an update are dropped, their storage is reused by new lanes.
+// The backends compare getRevision() with the revision their derived data (GPU buffer, rasterized
+// lane masks, segment boxes) was built from, so an unchanged frame skips all lane work
+class LaneCache
+{
+public:
+    // match the cache with "lanes". Returns true if the revision changed
+    // the dividers are only read during the call
+    bool update(const std::vector<LaneView>& lanes);
+    bool update(const std::vector<LaneData>& lanes);
+
+    // GL_TRIANGLES vertex data of lanes[j] of the last update
+    const std::vector<float32_t>& getVertexData(size_t j) const {return entries_[order_[j]].vertexData;};
+
+    // number of lanes of the last update
+    size_t getLaneCount() const {return order_.size();};
+
+    // changes whenever a mesh, the number or the order of the lanes changes. 0 before the first update
+    uint64_t getRevision() const {return revision_;};
+
+    // lanes triangulated by the last update
+    size_t getRebuildCount() const {return rebuildCount_;};
+
+    // content hash of the dividers
+    static uint64_t hash(const LaneView& lane);
+
+private:
+    struct Entry
+    {
+        uint32_t id{0u};
+        uint64_t hash{0u};
+        uint64_t lastUpdate{0u};    // update count of the last update which used the entry
+        std::vector<float32_t> vertexData{};
+    };
+
+    std::vector<Entry> entries_{};
+    std::vector<size_t> freeEntries_{};
+    std::unordered_map<uint32_t, size_t> entryOfId_{};
+
+    // entry of lanes[j] of the last update
+    std::vector<size_t> order_{};
+    std::vector<size_t> previousOrder_{};
+
+    FrameArena arena_{};    // triangulation scratch
+    std::vector<LaneView> views_{};
+    uint64_t updateCount_{0u};
+    uint64_t revision_{0u};
+    size_t rebuildCount_{0u};
+
+    // fill order_ with the entries of "lanes", triangulating new and changed lanes, and drop unused entries
+    void matchLanes(const std::vector<LaneView>& lanes, bool& changed);
+
+}; // class LaneCache
+
+#endif // LANE_CACHE_HPP
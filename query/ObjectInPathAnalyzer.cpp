@@ -1,8 +1,8 @@
 #include "ObjectInPathAnalyzer.hpp"
+#include "Triangulation.hpp"
 #include <iostream>
 #include <common/shader.hpp> // LoadShaders
-#include <algorithm> // std::copy
-#include <cmath> // std::sin std::cos
+#include <algorithm> // std::copy std::min std::max
 
 
 #define S1(x) #x
@@ -25,22 +25,59 @@ void checkGLError(const char* file, const char* line)
         checkGLError(__FILE__, __SLINE__); \
     }
 
-ObjectInPathAnalyzer::ObjectInPathAnalyzer()
+ObjectInPathAnalyzer::ObjectInPathAnalyzer(const RasterConfig& config)
 {
+    rasterConfig_ = config;
+    view_ = makeRasterView(config, config.roi);
+    fbWidth_ = view_.width;
+    fbHeight_ = view_.height;
+
     createFramebuffer();
     loadShaders();
 
-    glGenBuffers(1, &vertexbuffer_);
+    // lane meshes live in their own buffer, which is only respecified when the lanes change
+    CHECK_GL_ERROR(glGenVertexArrays(1, &laneVao_));
+    CHECK_GL_ERROR(glGenBuffers(1, &laneBuffer_));
+    glBindVertexArray(laneVao_);
+    glBindBuffer(GL_ARRAY_BUFFER, laneBuffer_);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+
+    pipeline_.resize(PIPELINE_DEPTH);
 }
 
 ObjectInPathAnalyzer::~ObjectInPathAnalyzer()
 {
     releaseFramebuffer();
 
+    glDeleteBuffers(1, &laneBuffer_);
+    glDeleteVertexArrays(1, &laneVao_);
 
-    glDeleteBuffers(1, &vertexbuffer_);
+    releaseQueries(queryPool_);
+    for (PendingFrame& frame : pipeline_)
+    {
+        releaseQueries(frame.queries);
+    }
+    if (queryResultBuffer_ != 0u)
+    {
+        glDeleteBuffers(1, &queryResultBuffer_);
+    }
+
+    if (laneMaskTexture_ != 0u)
+    {
+        glDeleteTextures(1, &laneMaskTexture_);
+        glDeleteFramebuffers(1, &laneMaskFbo_);
+    }
+
+    for (const GpuStageSpan& span : gpuStageSpans_)
+    {
+        timerQueryPool_.push_back(span.query);
+    }
+    releaseQueries(timerQueryPool_);
 
     CHECK_GL_ERROR(glDeleteProgram(programID_));
+    CHECK_GL_ERROR(glDeleteProgram(laneMaskProgramID_));
+    CHECK_GL_ERROR(glDeleteProgram(laneTestProgramID_));
 
 }
 
@@ -48,21 +85,24 @@ void ObjectInPathAnalyzer::process()
 {
     mockData();
 
+    setupView(makeRasterView(rasterConfig_, rasterConfig_.roi));
+
     // Clear the screen
     resetGLSettings();
 
-    GLuint VertexArrayID;
-    glGenVertexArrays(1, &VertexArrayID);
-    glBindVertexArray(VertexArrayID);
+    arena_.beginFrame();
+    DrawRange bgRange = arena_.append(bgData_, bgSize_ * 3u);
+    DrawRange fgRange = arena_.append(fgData_, fgSize_ * 3u);
+    arena_.upload();
 
     std::cerr << "render background" << std::endl;
-    renderBackground();
+    renderBackground(bgRange);
     std::cerr << "render foreground" << std::endl;
 
     GLuint queryForeground;
     glGenQueries(1, &queryForeground);
     glBeginQuery(GL_SAMPLES_PASSED, queryForeground);
-    renderForeground();
+    renderForeground(fgRange);
     glEndQuery(GL_SAMPLES_PASSED);
     GLboolean isValidQuery = glIsQuery(queryForeground);
     if (isValidQuery)
@@ -74,146 +114,907 @@ void ObjectInPathAnalyzer::process()
         std::cout << "foreground pixel count: " << pixelCount << std::endl;
     }
 
-    glDeleteVertexArrays(1, &VertexArrayID);
+    arena_.endFrame();
     glDeleteQueries(1, &queryForeground);
 }
 
-void ObjectInPathAnalyzer::process(const std::vector<LaneData>& lanes,
-                                   const std::vector<ObstacleData>& obstacles)
+void ObjectInPathAnalyzer::process(const std::vector<LaneView>& lanes,
+                                   const std::vector<ObstacleView>& obstacles,
+                                   std::vector<LaneAssignmentData>& result)
 {
-    outputData_.clear();
+    if (laneAssignmentMode_ == LaneAssignmentMode::PER_LANE)
+    {
+        processPerLane(lanes, obstacles, result);
+    }
+    else
+    {
+        processBatched(lanes, obstacles, result);
+    }
+}
+
+void ObjectInPathAnalyzer::processPerLane(const std::vector<LaneView>& lanes,
+                                          const std::vector<ObstacleView>& obstacles,
+                                          std::vector<LaneAssignmentData>& result)
+{
+    ++traceFrame_;
+    result.resize(obstacles.size());
     currColor = 0;
+    setupView(makeRasterView(rasterConfig_, obstacles));
     // Clear the screen
     resetGLSettings();
 
-    GLuint VertexArrayID;
-    glGenVertexArrays(1, &VertexArrayID);
-    glBindVertexArray(VertexArrayID);
-
+    // upload the whole frame at once
+    uint64_t stageBegin = stageClock();
+    arena_.beginFrame();
+    frameArena_.reset();
+    obstacleCache_.beginFrame();
+    obstacleRanges_.clear();
+    for (size_t i = 0u; i < obstacles.size(); ++i)
+    {
+        LaneAssignmentData& elem = result[i];
+        elem.obstacleId = obstacles[i].id;
+        elem.laneIds.clear();
+        elem.intersectionPixelCounts.clear();
+        elem.intersectionAreas.clear();
+        elem.coverageRatios.clear();
+        VertexSpan vertexData = obstacleCache_.triangulate(obstacles[i], frameArena_);
+        elem.obstacleVertexData.assign(vertexData.begin(), vertexData.end());
+        obstacleRanges_.push_back(arena_.append(vertexData.data, vertexData.size));
+    }
+    stageBegin = recordCpuStage(Stage::TRIANGULATION, stageBegin);
+    arena_.upload();
+    recordCpuStage(Stage::UPLOAD, stageBegin);
+    updateLaneBuffer(lanes);
+    stageBegin = stageClock();
+    findLaneCandidates(result);
+    recordCpuStage(Stage::TRIANGULATION, stageBegin);
+
+    // every query is read back right after its draw: the readback is part of the obstacle stage
     glDisable(GL_STENCIL_TEST);
-    for (const ObstacleData& obstacle : obstacles)
+    beginGpuStage(Stage::OBSTACLE_RASTER);
+    for (size_t i = 0u; i < obstacles.size(); ++i)
     {
-        outputData_.push_back({});
-        LaneAssignmentData& last = outputData_.back();
-        last.obstacleId = obstacle.id;
-        last.obstacleVertexData = trivialObstacleTriangulation(obstacle);
+        LaneAssignmentData& last = result[i];
 
         // gray obstacle rendering without stencil testing
-        std::vector<GLfloat> obsVertexData = trivialObstacleTriangulation(obstacle);
         RGBAColor rgba{};
         rgba.a = 0.5f;
-        uint32_t area = renderObstacle(obsVertexData, rgba); // obstacle total area
+        uint32_t area = renderObstacle(obstacleRanges_[i], rgba); // obstacle total area
         last.obstacleTotalPixelCount = area;
+        last.obstacleTotalArea = area * view_.getPixelArea();
     }
+    endGpuStage();
     glEnable(GL_STENCIL_TEST);
 
     // lane background with stencil buffer filling
-    for (const LaneData& lane: lanes)
+    const size_t wordCount = lanePyramid_.getWordCount();
+    for (size_t j = 0u; j < lanes.size(); ++j)
     {
-        uint32_t laneId = lane.id;
+        uint32_t laneId = lanes[j].id;
+
+        RGBColor rgb = getNextColor();
+        RGBAColor rgba(rgb, 0.3f);
+
+        // no obstacle near the lane
+        if (!CoveragePyramid::contains(usedLanes_.data(), j))
+        {
+            continue;
+        }
 
         glStencilMask(0xFF);
         glStencilFunc(GL_ALWAYS, 1, 0xFF);
         glClear(GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
         glStencilOp(GL_ZERO, GL_REPLACE, GL_REPLACE);
-        std::vector<GLfloat> laneVertexData = trivialLaneTriangulation(lane);
 
-        RGBColor rgb = getNextColor();
-        RGBAColor rgba(rgb, 0.3f);
-
-        renderLane(laneVertexData, rgba);
+        beginGpuStage(Stage::LANE_RASTER);
+        glBindVertexArray(laneVao_);
+        renderLane(laneRanges_[j], rgba);
+        arena_.bind();
+        endGpuStage();
 
         // enable stencil testing
         glStencilFunc(GL_EQUAL, 1, 0xFF);
         glStencilMask(0x00);
         // render all obstacles with stencil test/
+        beginGpuStage(Stage::OBSTACLE_RASTER);
         for (size_t i = 0u; i < obstacles.size(); ++i)
         {
-            const std::vector<GLfloat> obsVertexData = outputData_.at(i).obstacleVertexData;
+            if (!CoveragePyramid::contains(&laneCandidates_[i * wordCount], j))
+            {
+                continue;
+            }
             rgba.a = 0.9f;
 
-            uint32_t intersectionArea = renderObstacle(obsVertexData, rgba);
+            uint32_t intersectionArea = renderObstacle(obstacleRanges_[i], rgba);
 
             // push back (non-trivial) result to the output container
             if (intersectionArea > 0)
             {
                 // obstacle #i intersects with lane #laneId for "intersectionArea" pixel
-                outputData_.at(i).laneIds.push_back(laneId);
-                outputData_.at(i).intersectionPixelCounts.push_back(intersectionArea);
+                LaneAssignmentData& elem = result[i];
+                elem.laneIds.push_back(laneId);
+                elem.intersectionPixelCounts.push_back(intersectionArea);
+                elem.intersectionAreas.push_back(intersectionArea * view_.getPixelArea());
+                elem.coverageRatios.push_back(static_cast<float32_t>(intersectionArea) / elem.obstacleTotalPixelCount);
             }
         }
+        endGpuStage();
     }
 
-    glDeleteVertexArrays(1, &VertexArrayID);
+    arena_.endFrame();
+
+    collectGpuStages(traceFrame_);
+}
+
+void ObjectInPathAnalyzer::processBatched(const std::vector<LaneView>& lanes,
+                                          const std::vector<ObstacleView>& obstacles,
+                                          std::vector<LaneAssignmentData>& result)
+{
+    size_t queryCount = renderBatched(lanes, obstacles, result, lanePairs_, queryPool_);
+
+    // single readback for the whole frame
+    const uint64_t stageBegin = stageClock();
+    readQueryResults(queryPool_, queryCount);
+    recordCpuStage(Stage::READBACK, stageBegin);
 
-    // summarizing the result
-    for (const LaneAssignmentData& elem : outputData_)
+    laneIds_.clear();
+    for (const LaneView& lane : lanes)
     {
-        for (size_t i = 0u; i < elem.laneIds.size(); ++i)
-        {
-            float32_t ratio = static_cast<float32_t>(elem.intersectionPixelCounts.at(i)) / static_cast<float32_t>(elem.obstacleTotalPixelCount);
-            std::cout << "Obstacle #" << elem.obstacleId << " is lane assigned to lane #" << elem.laneIds.at(i) 
-                      << " for ratio " << ratio << std::endl;
-        }
+        laneIds_.push_back(lane.id);
     }
+    assignBatchedResults(laneIds_, lanePairs_, queryResults_, view_.getPixelArea(), result);
+
+    collectGpuStages(traceFrame_);
 }
 
-void ObjectInPathAnalyzer::process(const FreespaceData& freespace,
-                                   const std::vector<ObstacleData>& obstacles,
-                                   const std::vector<ObstacleData>& querys)
+size_t ObjectInPathAnalyzer::renderBatched(const std::vector<LaneView>& lanes,
+                                           const std::vector<ObstacleView>& obstacles,
+                                           std::vector<LaneAssignmentData>& output,
+                                           std::vector<LanePair>& pairs,
+                                           std::vector<GLuint>& queries)
 {
+    ++traceFrame_;
+    output.resize(obstacles.size());
+    currColor = 0;
+    setupView(makeRasterView(rasterConfig_, obstacles));
     // Clear the screen
     resetGLSettings();
 
-    GLuint VertexArrayID;
-    glGenVertexArrays(1, &VertexArrayID);
-    glBindVertexArray(VertexArrayID);
-
-    // render freespace background
-    glStencilMask(0xFF);
-    glStencilFunc(GL_ALWAYS, 1, 0xFF);
-    glClear(GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-    glStencilOp(GL_ZERO, GL_REPLACE, GL_REPLACE);
+    // upload the whole frame at once
+    uint64_t stageBegin = stageClock();
+    arena_.beginFrame();
+    frameArena_.reset();
+    obstacleCache_.beginFrame();
+    obstacleRanges_.clear();
+    for (size_t i = 0u; i < obstacles.size(); ++i)
+    {
+        LaneAssignmentData& elem = output[i];
+        elem.obstacleId = obstacles[i].id;
+        elem.laneIds.clear();
+        elem.intersectionPixelCounts.clear();
+        elem.obstacleTotalPixelCount = 0u;
+        elem.intersectionAreas.clear();
+        elem.coverageRatios.clear();
+        elem.obstacleTotalArea = 0.0f;
+        VertexSpan vertexData = obstacleCache_.triangulate(obstacles[i], frameArena_);
+        elem.obstacleVertexData.assign(vertexData.begin(), vertexData.end());
+        obstacleRanges_.push_back(arena_.append(vertexData.data, vertexData.size));
+    }
+    stageBegin = recordCpuStage(Stage::TRIANGULATION, stageBegin);
+    arena_.upload();
+    recordCpuStage(Stage::UPLOAD, stageBegin);
+    updateLaneBuffer(lanes);
+    stageBegin = stageClock();
+    findLaneCandidates(output);
+
+    // only the pairs which may overlap are queried
+    const size_t wordCount = lanePyramid_.getWordCount();
+    pairs.clear();
+    for (size_t j = 0u; j < lanes.size(); ++j)
+    {
+        for (size_t i = 0u; i < obstacles.size() && CoveragePyramid::contains(usedLanes_.data(), j); ++i)
+        {
+            if (CoveragePyramid::contains(&laneCandidates_[i * wordCount], j))
+            {
+                pairs.push_back(LanePair{static_cast<uint32_t>(j), static_cast<uint32_t>(i)});
+            }
+        }
+    }
 
-    std::vector<GLfloat> fsVertexData = trivialFreespaceTriangulation(freespace);
-    RGBAColor fsColor{};
-    fsColor.a = 0.3f;
-    renderFreespace(fsVertexData, fsColor);
+    recordCpuStage(Stage::TRIANGULATION, stageBegin);
 
-    glStencilFunc(GL_ALWAYS, 1, 0xFF);
-    glStencilOp(GL_ZERO, GL_REPLACE, GL_ZERO);
+    // query layout: [total area of obstacle #i] followed by [intersection of pairs[k]] at index obstacles.size() + k
+    reserveQueries(queries, obstacles.size() + pairs.size());
+    size_t queryCount = 0u;
 
-    for (const ObstacleData& obstacle : obstacles)
+    glDisable(GL_STENCIL_TEST);
+    beginGpuStage(Stage::OBSTACLE_RASTER);
+    for (size_t i = 0u; i < obstacles.size(); ++i)
     {
         // gray obstacle rendering without stencil testing
-        std::vector<GLfloat> obsVertexData = trivialObstacleTriangulation(obstacle);
         RGBAColor rgba{};
         rgba.a = 0.5f;
+        glBeginQuery(GL_SAMPLES_PASSED, queries[queryCount++]);
+        drawObstacle(obstacleRanges_[i], rgba);
+        glEndQuery(GL_SAMPLES_PASSED);
+    }
+    endGpuStage();
+    if (laneAssignmentMode_ == LaneAssignmentMode::LANE_MASK)
+    {
+        updateLaneMask();
+        beginGpuStage(Stage::OBSTACLE_RASTER);
+        queryCount = renderMaskedPairs(pairs, queries, queryCount);
+        endGpuStage();
+        arena_.endFrame();
 
-        renderObstacle(obsVertexData, rgba); // obstacle total area
+        return queryCount;
     }
+    glEnable(GL_STENCIL_TEST);
+
+    // every lane of a group owns one stencil bit, so overlapping lanes do not overwrite each other
+    size_t pair = 0u;
+    for (size_t groupBegin = 0u; groupBegin < lanes.size(); groupBegin += STENCIL_LANE_BITS)
+    {
+        const size_t groupEnd = std::min(lanes.size(), groupBegin + STENCIL_LANE_BITS);
+
+        // no obstacle near any lane of the group
+        if (pair == pairs.size() || pairs[pair].lane >= groupEnd)
+        {
+            continue;
+        }
+
+        beginGpuStage(Stage::LANE_RASTER);
+        glStencilMask(0xFF);
+        glClear(GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+        glStencilFunc(GL_ALWAYS, 0xFF, 0xFF);
+        glStencilOp(GL_KEEP, GL_REPLACE, GL_REPLACE);
+
+        glBindVertexArray(laneVao_);
+        for (size_t j = groupBegin; j < groupEnd; ++j)
+        {
+            RGBColor rgb = getNextColor();
+            if (!CoveragePyramid::contains(usedLanes_.data(), j))
+            {
+                continue;
+            }
+            glStencilMask(1u << (j - groupBegin));
+            renderLane(laneRanges_[j], RGBAColor(rgb, 0.3f));
+        }
+        arena_.bind();
+        endGpuStage();
+
+        // render the candidate obstacles once per lane bit, without waiting for any query result
+        glStencilMask(0x00);
+        beginGpuStage(Stage::OBSTACLE_RASTER);
+        for (; pair < pairs.size() && pairs[pair].lane < groupEnd; ++pair)
+        {
+            const size_t j = pairs[pair].lane;
+            const GLuint laneBit = 1u << (j - groupBegin);
+            glStencilFunc(GL_EQUAL, laneBit, laneBit);
+
+            RGBAColor rgba(COLOR_SET[j % 6u], 0.9f);
+            glBeginQuery(GL_SAMPLES_PASSED, queries[queryCount++]);
+            drawObstacle(obstacleRanges_[pairs[pair].obstacle], rgba);
+            glEndQuery(GL_SAMPLES_PASSED);
+        }
+        endGpuStage();
+    }
+
+    arena_.endFrame();
+
+    return queryCount;
+}
+
+void ObjectInPathAnalyzer::updateLaneBuffer(const std::vector<LaneView>& lanes)
+{
+    uint64_t stageBegin = stageClock();
+    laneCache_.update(lanes);
+    if (laneCache_.getRevision() == laneBufferRevision_)
+    {
+        recordCpuStage(Stage::TRIANGULATION, stageBegin);
+        return;
+    }
+    laneBufferRevision_ = 0u;
+
+    // gather every lane mesh, then respecify the buffer in one call
+    size_t floatCount = 0u;
+    for (size_t j = 0u; j < laneCache_.getLaneCount(); ++j)
+    {
+        floatCount += laneCache_.getVertexData(j).size();
+    }
+    VertexSpan vertexData = frameArena_.allocate(floatCount);
+
+    laneRanges_.clear();
+    float32_t* out = vertexData.data;
+    for (size_t j = 0u; j < laneCache_.getLaneCount(); ++j)
+    {
+        const std::vector<float32_t>& laneVertexData = laneCache_.getVertexData(j);
+        DrawRange range{};
+        range.first = static_cast<GLint>((out - vertexData.data) / 3);
+        range.count = static_cast<GLsizei>(laneVertexData.size() / 3u);
+        laneRanges_.push_back(range);
+        out = std::copy(laneVertexData.begin(), laneVertexData.end(), out);
+    }
+
+    stageBegin = recordCpuStage(Stage::TRIANGULATION, stageBegin);
+    glBindBuffer(GL_ARRAY_BUFFER, laneBuffer_);
+    CHECK_GL_ERROR(glBufferData(GL_ARRAY_BUFFER, vertexData.size * sizeof(GLfloat), vertexData.data, GL_DYNAMIC_DRAW));
+    arena_.bind();
+    stageBegin = recordCpuStage(Stage::UPLOAD, stageBegin);
+
+    lanePyramid_.build(laneCache_);
+    recordCpuStage(Stage::TRIANGULATION, stageBegin);
 
+    laneBufferRevision_ = laneCache_.getRevision();
+}
+
+void ObjectInPathAnalyzer::updateLaneMask()
+{
+    if (laneCache_.getRevision() == laneMaskRevision_ && view_ == laneMaskView_)
+    {
+        return;
+    }
+    laneMaskRevision_ = 0u;
+
+    const uint32_t layerCount = std::max<uint32_t>(1u, (laneCache_.getLaneCount() + LANE_MASK_BITS - 1u) / LANE_MASK_BITS);
+    if (laneMaskTexture_ == 0u)
+    {
+        CHECK_GL_ERROR(glGenTextures(1, &laneMaskTexture_));
+        CHECK_GL_ERROR(glGenFramebuffers(1, &laneMaskFbo_));
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, laneMaskTexture_);
+    if (laneMaskWidth_ != fbWidth_ || laneMaskHeight_ != fbHeight_ || laneMaskLayers_ < layerCount)
+    {
+        // the mask follows the size of the framebuffer, so that the same viewport and scissor apply
+        laneMaskWidth_ = fbWidth_;
+        laneMaskHeight_ = fbHeight_;
+        laneMaskLayers_ = std::max(laneMaskLayers_, layerCount);
+        CHECK_GL_ERROR(glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R32UI, laneMaskWidth_, laneMaskHeight_, laneMaskLayers_,
+                                    0, GL_RED_INTEGER, GL_UNSIGNED_INT, NULL));
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, 0);
+    }
+
+    // every lane ORs its own bit, so overlapping lanes keep both bits. Integer targets are never blended
+    beginGpuStage(Stage::LANE_RASTER);
+    glBindFramebuffer(GL_FRAMEBUFFER, laneMaskFbo_);
+    glUseProgram(laneMaskProgramID_);
+    setViewTransform(laneMaskViewLocation_);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_STENCIL_TEST);
+    glEnable(GL_COLOR_LOGIC_OP);
+    glLogicOp(GL_OR);
+    glBindVertexArray(laneVao_);
+    for (uint32_t layer = 0u; layer < layerCount; ++layer)
+    {
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, laneMaskTexture_, 0, layer);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        {
+            throw std::runtime_error("incomplete lane mask framebuffer\n");
+        }
+        const GLuint zero[4] = {0u, 0u, 0u, 0u};
+        glClearBufferuiv(GL_COLOR, 0, zero);
+
+        const size_t laneEnd = std::min<size_t>(laneCache_.getLaneCount(), (layer + 1u) * LANE_MASK_BITS);
+        for (size_t j = layer * LANE_MASK_BITS; j < laneEnd; ++j)
+        {
+            glUniform1ui(laneMaskBitLocation_, 1u << (j % LANE_MASK_BITS));
+            glDrawArrays(GL_TRIANGLES, laneRanges_[j].first, laneRanges_[j].count);
+        }
+    }
+    glDisable(GL_COLOR_LOGIC_OP);
+    glEnable(GL_DEPTH_TEST);
+    arena_.bind();
+    glUseProgram(programID_);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+    endGpuStage();
+
+    laneMaskRevision_ = laneCache_.getRevision();
+    laneMaskView_ = view_;
+}
+
+size_t ObjectInPathAnalyzer::renderMaskedPairs(const std::vector<LanePair>& pairs,
+                                               std::vector<GLuint>& queries,
+                                               size_t queryCount)
+{
+    // no stencil clear and no lane draw: every pair only draws its obstacle once
+    glUseProgram(laneTestProgramID_);
+    setViewTransform(laneTestViewLocation_);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, laneMaskTexture_);
+    glDisable(GL_STENCIL_TEST);
+    for (const LanePair& pair : pairs)
+    {
+        RGBAColor rgba(COLOR_SET[pair.lane % 6u], 0.9f);
+        glUniform4fv(laneTestColorLocation_, 1, reinterpret_cast<float32_t*>(&rgba));
+        glUniform1i(laneTestLayerLocation_, static_cast<GLint>(pair.lane / LANE_MASK_BITS));
+        glUniform1ui(laneTestBitLocation_, 1u << (pair.lane % LANE_MASK_BITS));
+
+        const DrawRange range = obstacleRanges_[pair.obstacle];
+        glBeginQuery(GL_SAMPLES_PASSED, queries[queryCount++]);
+        glDrawArrays(GL_TRIANGLES, range.first, range.count);
+        glEndQuery(GL_SAMPLES_PASSED);
+    }
+    glUseProgram(programID_);
+
+    return queryCount;
+}
+
+void ObjectInPathAnalyzer::findLaneCandidates(const std::vector<LaneAssignmentData>& output)
+{
+    // a margin of one pixel covers the snapping of the rasterizer
+    const size_t wordCount = lanePyramid_.getWordCount();
+    laneCandidates_.resize(output.size() * wordCount);
+    usedLanes_.assign(wordCount, 0u);
+    for (size_t i = 0u; i < output.size(); ++i)
+    {
+        const std::vector<float32_t>& vertexData = output[i].obstacleVertexData;
+        uint64_t* candidates = &laneCandidates_[i * wordCount];
+        lanePyramid_.query(vertexData.data(), vertexData.size(), view_.metresPerPixel, candidates);
+        for (size_t w = 0u; w < wordCount; ++w)
+        {
+            usedLanes_[w] |= candidates[w];
+        }
+    }
+}
+
+void ObjectInPathAnalyzer::assignBatchedResults(const std::vector<uint32_t>& laneIds,
+                                                const std::vector<LanePair>& pairs,
+                                                const std::vector<GLuint>& results,
+                                                float32_t pixelArea,
+                                                std::vector<LaneAssignmentData>& output)
+{
+    const size_t obstacleCount = output.size();
+    for (size_t i = 0u; i < obstacleCount; ++i)
+    {
+        output[i].obstacleTotalPixelCount = results[i];
+        output[i].obstacleTotalArea = results[i] * pixelArea;
+    }
+    // pairs are ordered by lane, so every lane list keeps the order of the lanes
+    for (size_t k = 0u; k < pairs.size(); ++k)
+    {
+        const size_t i = pairs[k].obstacle;
+        uint32_t intersectionArea = results[obstacleCount + k];
+
+        // push back (non-trivial) result to the output container
+        if (intersectionArea > 0)
+        {
+            output[i].laneIds.push_back(laneIds[pairs[k].lane]);
+            output[i].intersectionPixelCounts.push_back(intersectionArea);
+            output[i].intersectionAreas.push_back(intersectionArea * pixelArea);
+            output[i].coverageRatios.push_back(static_cast<float32_t>(intersectionArea) / results[i]);
+        }
+    }
+}
+
+FrameTicket ObjectInPathAnalyzer::submit(const std::vector<LaneData>& lanes,
+                                         const std::vector<ObstacleData>& obstacles)
+{
+    makeLaneViews(lanes, laneViews_);
+    makeObstacleViews(obstacles, obstacleViews_);
+    return submit(laneViews_, obstacleViews_);
+}
+
+FrameTicket ObjectInPathAnalyzer::submit(const std::vector<LaneView>& lanes,
+                                         const std::vector<ObstacleView>& obstacles)
+{
+    // take a free slot, add one only if every slot is still waiting to be harvested
+    PendingFrame* frame = nullptr;
+    for (PendingFrame& elem : pipeline_)
+    {
+        if (!elem.inFlight)
+        {
+            frame = &elem;
+            break;
+        }
+    }
+    if (frame == nullptr)
+    {
+        pipeline_.emplace_back();
+        frame = &pipeline_.back();
+    }
+
+    frame->ticket = nextTicket_++;
+    frame->inFlight = true;
+    frame->queryCount = renderBatched(lanes, obstacles, frame->result, frame->lanePairs, frame->queries);
+    frame->pixelArea = view_.getPixelArea();
+    frame->traceFrame = traceFrame_;
+    frame->laneIds.clear();
+    for (const LaneView& lane : lanes)
+    {
+        frame->laneIds.push_back(lane.id);
+    }
+    ++framesInFlight_;
+
+    // make sure the GPU starts working on the frame before it is polled
+    glFlush();
+
+    return frame->ticket;
+}
+
+bool ObjectInPathAnalyzer::harvest(FrameTicket& ticket, std::vector<LaneAssignmentData>& result, bool wait)
+{
+    PendingFrame* oldest = nullptr;
+    for (PendingFrame& elem : pipeline_)
+    {
+        if (elem.inFlight && (oldest == nullptr || elem.ticket < oldest->ticket))
+        {
+            oldest = &elem;
+        }
+    }
+    if (oldest == nullptr)
+    {
+        return false;
+    }
+
+    // queries complete in submission order, so the last one tells if the whole frame is done
+    if (!wait && oldest->queryCount > 0u)
+    {
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv(oldest->queries[oldest->queryCount - 1u], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available == GL_FALSE)
+        {
+            return false;
+        }
+    }
+
+    const uint64_t stageBegin = stageClock();
+    readQueryResults(oldest->queries, oldest->queryCount);
+    if (profiling_)
+    {
+        StageEvent event{};
+        event.frame = oldest->traceFrame;
+        event.stage = Stage::READBACK;
+        event.begin = stageBegin;
+        event.duration = StageTrace::now() - stageBegin;
+        stageTrace_.push(event);
+    }
+    assignBatchedResults(oldest->laneIds, oldest->lanePairs, queryResults_, oldest->pixelArea, oldest->result);
+    collectGpuStages(oldest->traceFrame);
+
+    ticket = oldest->ticket;
+    std::swap(result, oldest->result);
+    oldest->inFlight = false;
+    --framesInFlight_;
+
+    return true;
+}
+
+void ObjectInPathAnalyzer::reserveQueries(std::vector<GLuint>& queries, size_t count)
+{
+    if (queries.size() < count)
+    {
+        const size_t oldSize = queries.size();
+        queries.resize(count);
+        CHECK_GL_ERROR(glGenQueries(count - oldSize, &queries[oldSize]));
+    }
+}
+
+void ObjectInPathAnalyzer::releaseQueries(std::vector<GLuint>& queries)
+{
+    if (!queries.empty())
+    {
+        glDeleteQueries(queries.size(), queries.data());
+        queries.clear();
+    }
+}
+
+void ObjectInPathAnalyzer::readQueryResults(const std::vector<GLuint>& queries, size_t count)
+{
+    queryResults_.resize(count);
+    if (count == 0u)
+    {
+        return;
+    }
+
+    if (GLEW_ARB_query_buffer_object)
+    {
+        // let the GPU write every result into one buffer, then download it at once
+        if (queryResultBuffer_ == 0u)
+        {
+            glGenBuffers(1, &queryResultBuffer_);
+        }
+        glBindBuffer(GL_QUERY_BUFFER, queryResultBuffer_);
+        if (queryResultBufferSize_ < count)
+        {
+            queryResultBufferSize_ = count;
+            glBufferData(GL_QUERY_BUFFER, count * sizeof(GLuint), NULL, GL_STREAM_READ);
+        }
+        for (size_t i = 0u; i < count; ++i)
+        {
+            glGetQueryObjectuiv(queries[i], GL_QUERY_RESULT,
+                                reinterpret_cast<GLuint*>(i * sizeof(GLuint)));
+        }
+        CHECK_GL_ERROR(glGetBufferSubData(GL_QUERY_BUFFER, 0, count * sizeof(GLuint), queryResults_.data()));
+        glBindBuffer(GL_QUERY_BUFFER, 0);
+    }
+    else
+    {
+        // queries complete in submission order: only the first read may wait for the GPU
+        for (size_t i = 0u; i < count; ++i)
+        {
+            glGetQueryObjectuiv(queries[i], GL_QUERY_RESULT, &queryResults_[i]);
+        }
+    }
+}
+
+uint64_t ObjectInPathAnalyzer::recordCpuStage(Stage stage, uint64_t begin)
+{
+    if (!profiling_)
+    {
+        return 0u;
+    }
+
+    const uint64_t end = StageTrace::now();
+    StageEvent event{};
+    event.frame = traceFrame_;
+    event.stage = stage;
+    event.begin = begin;
+    event.duration = end - begin;
+    stageTrace_.push(event);
+
+    return end;
+}
+
+void ObjectInPathAnalyzer::beginGpuStage(Stage stage)
+{
+    if (!profiling_)
+    {
+        return;
+    }
+
+    if (timerQueryPool_.empty())
+    {
+        reserveQueries(timerQueryPool_, 16u);
+    }
+    GpuStageSpan span{traceFrame_, stage, StageTrace::now(), timerQueryPool_.back()};
+    timerQueryPool_.pop_back();
+    glBeginQuery(GL_TIME_ELAPSED, span.query);
+    gpuStageSpans_.push_back(span);
+    gpuStageActive_ = true;
+}
+
+void ObjectInPathAnalyzer::endGpuStage()
+{
+    if (gpuStageActive_)
+    {
+        glEndQuery(GL_TIME_ELAPSED);
+        gpuStageActive_ = false;
+    }
+}
+
+void ObjectInPathAnalyzer::collectGpuStages(uint64_t frame)
+{
+    size_t collected = 0u;
+    while (collected < gpuStageSpans_.size())
+    {
+        const uint64_t spanFrame = gpuStageSpans_[collected].frame;
+        size_t frameEnd = collected;
+        while (frameEnd < gpuStageSpans_.size() && gpuStageSpans_[frameEnd].frame == spanFrame)
+        {
+            ++frameEnd;
+        }
+
+        // queries complete in issue order, so the last one tells if the whole frame is done
+        if (spanFrame > frame)
+        {
+            GLuint available = GL_FALSE;
+            glGetQueryObjectuiv(gpuStageSpans_[frameEnd - 1u].query, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available == GL_FALSE)
+            {
+                break;
+            }
+        }
+
+        StageEvent events[STAGE_COUNT] = {};
+        bool used[STAGE_COUNT] = {};
+        for (size_t k = collected; k < frameEnd; ++k)
+        {
+            const GpuStageSpan& span = gpuStageSpans_[k];
+            GLuint64 elapsed = 0u;
+            glGetQueryObjectui64v(span.query, GL_QUERY_RESULT, &elapsed);
+            timerQueryPool_.push_back(span.query);
+
+            const size_t stage = static_cast<size_t>(span.stage);
+            if (!used[stage])
+            {
+                used[stage] = true;
+                events[stage].frame = spanFrame;
+                events[stage].stage = span.stage;
+                events[stage].gpu = true;
+                events[stage].begin = span.issued;
+            }
+            events[stage].duration += elapsed;
+        }
+        for (size_t stage = 0u; stage < STAGE_COUNT; ++stage)
+        {
+            if (used[stage])
+            {
+                stageTrace_.push(events[stage]);
+            }
+        }
+
+        collected = frameEnd;
+    }
+    gpuStageSpans_.erase(gpuStageSpans_.begin(), gpuStageSpans_.begin() + collected);
+}
+
+void ObjectInPathAnalyzer::process(const FreespaceBeams& freespace,
+                                   const std::vector<ObstacleData>& obstacles,
+                                   const std::vector<ObstacleData>& querys,
+                                   std::vector<QueryCollisionData>& result)
+{
+    setupView(makeRasterView(rasterConfig_, querys));
+
+    // Clear the screen
+    resetGLSettings();
+
+    // upload the whole frame at once
+    arena_.beginFrame();
+    frameArena_.reset();
+    obstacleCache_.beginFrame();
+    queryCache_.beginFrame();
+    VertexSpan fsVertexData = freespaceBuilder_.build(freespace, frameArena_);
+    DrawRange fsRange = arena_.append(fsVertexData.data, fsVertexData.size);
+    obstacleRanges_.clear();
+    for (const ObstacleData& obstacle : obstacles)
+    {
+        VertexSpan vertexData = obstacleCache_.triangulate(obstacle, frameArena_);
+        obstacleRanges_.push_back(arena_.append(vertexData.data, vertexData.size));
+    }
+    queryRanges_.clear();
+    for (const ObstacleData& query : querys)
+    {
+        VertexSpan vertexData = queryCache_.triangulate(query, frameArena_);
+        queryRanges_.push_back(arena_.append(vertexData.data, vertexData.size));
+    }
+    arena_.upload();
+
+    renderFreespaceMask(fsRange);
+
+    // one query per query, all read back at once
+    reserveQueries(queryPool_, querys.size());
     glStencilMask(0x00);
     glStencilFunc(GL_EQUAL, 0, 0xFF);
-    for (const ObstacleData& query : querys)
+    for (size_t q = 0u; q < querys.size(); ++q)
     {
-        // gray obstacle rendering without stencil testing
-        std::vector<GLfloat> queryVertexData = trivialObstacleTriangulation(query);
         RGBAColor queryColor{};
         queryColor.r = 1.0f;
         queryColor.a = 0.7f;
-        std::vector<GLfloat> queryColorData{};
 
-        uint32_t area = renderObstacle(queryVertexData, queryColor); // obstacle total area
-        if (area > 0)
+        glBeginQuery(GL_SAMPLES_PASSED, queryPool_[q]);
+        drawObstacle(queryRanges_[q], queryColor);
+        glEndQuery(GL_SAMPLES_PASSED);
+    }
+
+    arena_.endFrame();
+
+    readQueryResults(queryPool_, querys.size());
+    result.resize(querys.size());
+    for (size_t q = 0u; q < querys.size(); ++q)
+    {
+        // the pixels of the query which pass the stencil test are outside the freespace or on an obstacle
+        QueryCollisionData& elem = result[q];
+        elem.queryId = querys[q].id;
+        elem.collisionPixelCount = queryResults_[q];
+        elem.collisionArea = queryResults_[q] * view_.getPixelArea();
+        elem.collision = queryResults_[q] > 0u;
+    }
+}
+
+void ObjectInPathAnalyzer::process(const FreespaceBeams& freespace,
+                                   const std::vector<ObstacleData>& obstacles,
+                                   const std::vector<TrajectoryData>& trajectories,
+                                   std::vector<TrajectoryCollisionData>& result)
+{
+    setupView(makeRasterView(rasterConfig_, trajectories));
+
+    // Clear the screen
+    resetGLSettings();
+
+    // upload the whole frame at once, the footprints of all trajectories one after the other
+    arena_.beginFrame();
+    frameArena_.reset();
+    obstacleCache_.beginFrame();
+    queryCache_.beginFrame();
+    VertexSpan fsVertexData = freespaceBuilder_.build(freespace, frameArena_);
+    DrawRange fsRange = arena_.append(fsVertexData.data, fsVertexData.size);
+    obstacleRanges_.clear();
+    for (const ObstacleData& obstacle : obstacles)
+    {
+        VertexSpan vertexData = obstacleCache_.triangulate(obstacle, frameArena_);
+        obstacleRanges_.push_back(arena_.append(vertexData.data, vertexData.size));
+    }
+    queryRanges_.clear();
+    for (const TrajectoryData& trajectory : trajectories)
+    {
+        for (const ObstacleData& footprint : trajectory.footprints)
         {
-            std::cout << "collision happened" << std::endl;
+            VertexSpan vertexData = queryCache_.triangulate(footprint, frameArena_);
+            queryRanges_.push_back(arena_.append(vertexData.data, vertexData.size));
         }
     }
+    arena_.upload();
+
+    renderFreespaceMask(fsRange);
+
+    // every trajectory owns one of the stencil bits above the freespace bit: a colliding pixel passes the
+    // test once, then its bit is set, so the swept volume is counted once however often footprints overlap.
+    // One query per footprint: the first footprint with a non-zero count is the first colliding pose
+    reserveQueries(queryPool_, queryRanges_.size());
+    glStencilOp(GL_KEEP, GL_KEEP, GL_INVERT);
+    RGBAColor sweepColor{};
+    sweepColor.r = 1.0f;
+    sweepColor.a = 0.3f;
+    size_t pose = 0u;
+    for (size_t t = 0u; t < trajectories.size(); ++t)
+    {
+        const GLuint trajectoryBit = 2u << (t % STENCIL_SWEEP_BITS);
+        if (t > 0u && t % STENCIL_SWEEP_BITS == 0u)
+        {
+            // release the bits of the previous group, the freespace bit is kept
+            glStencilMask(0xFE);
+            glClear(GL_STENCIL_BUFFER_BIT);
+        }
+        glStencilMask(trajectoryBit);
+        glStencilFunc(GL_EQUAL, 0, 0x01 | trajectoryBit);
+
+        for (size_t k = 0u; k < trajectories[t].footprints.size(); ++k, ++pose)
+        {
+            glBeginQuery(GL_SAMPLES_PASSED, queryPool_[pose]);
+            drawObstacle(queryRanges_[pose], sweepColor);
+            glEndQuery(GL_SAMPLES_PASSED);
+        }
+    }
+
+    arena_.endFrame();
 
-    glDeleteVertexArrays(1, &VertexArrayID);
+    readQueryResults(queryPool_, queryRanges_.size());
+    result.resize(trajectories.size());
+    pose = 0u;
+    for (size_t t = 0u; t < trajectories.size(); ++t)
+    {
+        TrajectoryCollisionData& elem = result[t];
+        elem.trajectoryId = trajectories[t].id;
+        elem.collisionPixelCount = 0u;
+        elem.firstCollidingPose = -1;
+        for (size_t k = 0u; k < trajectories[t].footprints.size(); ++k, ++pose)
+        {
+            if (queryResults_[pose] > 0u && elem.firstCollidingPose < 0)
+            {
+                elem.firstCollidingPose = static_cast<int32_t>(k);
+            }
+            elem.collisionPixelCount += queryResults_[pose];
+        }
+        elem.collisionArea = elem.collisionPixelCount * view_.getPixelArea();
+        elem.collision = elem.collisionPixelCount > 0u;
+    }
 }
 
+void ObjectInPathAnalyzer::renderFreespaceMask(DrawRange fsRange)
+{
+    // render freespace background
+    glStencilMask(0xFF);
+    glStencilFunc(GL_ALWAYS, 1, 0xFF);
+    glClear(GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+    glStencilOp(GL_ZERO, GL_REPLACE, GL_REPLACE);
+
+    RGBAColor fsColor{};
+    fsColor.a = 0.3f;
+    renderFreespace(fsRange, fsColor);
+
+    glStencilFunc(GL_ALWAYS, 1, 0xFF);
+    glStencilOp(GL_ZERO, GL_REPLACE, GL_ZERO);
+
+    for (const DrawRange& range : obstacleRanges_)
+    {
+        // gray obstacle rendering without stencil testing
+        RGBAColor rgba{};
+        rgba.a = 0.5f;
+
+        drawObstacle(range, rgba);
+    }
+}
 
 void ObjectInPathAnalyzer::createFramebuffer()
 {
@@ -225,7 +1026,7 @@ void ObjectInPathAnalyzer::createFramebuffer()
     CHECK_GL_ERROR(glGenTextures(1, &colorTexture_));
     CHECK_GL_ERROR(glBindTexture(GL_TEXTURE_2D, colorTexture_));
     
-    CHECK_GL_ERROR(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, WIN_W, WIN_H, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL));
+    CHECK_GL_ERROR(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, fbWidth_, fbHeight_, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL));
 
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);  
@@ -236,7 +1037,7 @@ void ObjectInPathAnalyzer::createFramebuffer()
     glGenTextures(1, &depthTexture_);
     glBindTexture(GL_TEXTURE_2D, depthTexture_);
 
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, WIN_W, WIN_H, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, NULL);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, fbWidth_, fbHeight_, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, NULL);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, depthTexture_, 0);  
 
     if(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE)
@@ -249,6 +1050,40 @@ void ObjectInPathAnalyzer::createFramebuffer()
     }
 }
 
+void ObjectInPathAnalyzer::resizeFramebuffer(uint32_t width, uint32_t height)
+{
+    if (width <= fbWidth_ && height <= fbHeight_)
+    {
+        return;
+    }
+    fbWidth_ = std::max(fbWidth_, width);
+    fbHeight_ = std::max(fbHeight_, height);
+
+    // respecify the attachments, the framebuffer object itself stays the same
+    CHECK_GL_ERROR(glBindTexture(GL_TEXTURE_2D, colorTexture_));
+    CHECK_GL_ERROR(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, fbWidth_, fbHeight_, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL));
+    CHECK_GL_ERROR(glBindTexture(GL_TEXTURE_2D, depthTexture_));
+    CHECK_GL_ERROR(glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, fbWidth_, fbHeight_, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, NULL));
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        throw std::runtime_error("incomplete framebuffer\n");
+    }
+}
+
+void ObjectInPathAnalyzer::setupView(const RasterView& view)
+{
+    view_ = view;
+    resizeFramebuffer(view_.width, view_.height);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+
+    // clears are limited by the scissor box too, so pixels outside of the view are never touched
+    glViewport(0, 0, view_.width, view_.height);
+    glScissor(0, 0, view_.width, view_.height);
+    setViewTransform(viewLocation_);
+}
+
 void ObjectInPathAnalyzer::releaseFramebuffer()
 {
     glDeleteTextures(1, &colorTexture_);
@@ -263,10 +1098,43 @@ void ObjectInPathAnalyzer::loadShaders()
 
     // Use our shader
     glUseProgram(programID_);
+
+    colorLocation_ = glGetUniformLocation(programID_, "colorIn");
+    viewLocation_ = glGetUniformLocation(programID_, "viewTransform");
+
+    laneMaskProgramID_ = LoadShaders("../query/SimpleVertexShader.vertexshader",
+                                     "../query/LaneMaskFragmentShader.fragmentshader");
+    laneMaskViewLocation_ = glGetUniformLocation(laneMaskProgramID_, "viewTransform");
+    laneMaskBitLocation_ = glGetUniformLocation(laneMaskProgramID_, "laneBit");
+
+    laneTestProgramID_ = LoadShaders("../query/SimpleVertexShader.vertexshader",
+                                     "../query/LaneTestFragmentShader.fragmentshader");
+    laneTestViewLocation_ = glGetUniformLocation(laneTestProgramID_, "viewTransform");
+    laneTestColorLocation_ = glGetUniformLocation(laneTestProgramID_, "colorIn");
+    laneTestLayerLocation_ = glGetUniformLocation(laneTestProgramID_, "laneLayer");
+    laneTestBitLocation_ = glGetUniformLocation(laneTestProgramID_, "laneBit");
+    glUseProgram(laneTestProgramID_);
+    glUniform1i(glGetUniformLocation(laneTestProgramID_, "laneMask"), 0);  // texture unit 0
+
+    glUseProgram(programID_);
+}
+
+void ObjectInPathAnalyzer::setViewTransform(GLint location)
+{
+    glUniform4f(location, view_.getScaleX(), view_.getScaleY(), view_.getOffsetX(), view_.getOffsetY());
+}
+
+void ObjectInPathAnalyzer::setColor(RGBAColor color)
+{
+    glUniform4fv(colorLocation_, 1, reinterpret_cast<float32_t*>(&color));
 }
 
 void ObjectInPathAnalyzer::resetGLSettings()
 {
+    // the write masks left by the previous call also mask the clears
+    glDepthMask(GL_TRUE);
+    glStencilMask(0xFF);
+
     glClearColor(1.0f, 1.0f, 1.0f, 0.0f);
     glClear(GL_COLOR_BUFFER_BIT);
     glClear(GL_STENCIL_BUFFER_BIT);
@@ -282,7 +1150,7 @@ void ObjectInPathAnalyzer::resetGLSettings()
     glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
 }
 
-void ObjectInPathAnalyzer::renderBackground()
+void ObjectInPathAnalyzer::renderBackground(DrawRange range)
 {
     glStencilMask(0xFF);
     glStencilFunc(GL_ALWAYS, 1, 0xFF);
@@ -292,34 +1160,12 @@ void ObjectInPathAnalyzer::renderBackground()
     RGBAColor color{};
     color.g = 1.0f;
     color.a = 0.5f;
-    auto uColor = glGetUniformLocation(programID_, "colorIn");
-    glUniform4fv(uColor, 1, reinterpret_cast<float32_t*>(&color));
-
-    GLuint vertexbuffer;
-    glGenBuffers(1, &vertexbuffer);
-    glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer);
-    glBufferData(GL_ARRAY_BUFFER, bgSize_ * 3 * sizeof(GLfloat), bgData_, GL_STATIC_DRAW);
-
-    // 1rst attribute buffer : vertices
-    glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer);
-    glVertexAttribPointer(
-        0,                  // attribute 0. No particular reason for 0, but must match the layout in the shader.
-        3,                  // size
-        GL_FLOAT,           // type
-        GL_FALSE,           // normalized?
-        0,                  // stride
-        (void*)0            // array buffer offset
-    );
-
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4); // 3 indices starting at 0 -> 1 triangle
+    setColor(color);
 
-    glDisableVertexAttribArray(0);
-
-    glDeleteBuffers(1, &vertexbuffer);
+    glDrawArrays(GL_TRIANGLE_STRIP, range.first, range.count);
 }
 
-void ObjectInPathAnalyzer::renderForeground()
+void ObjectInPathAnalyzer::renderForeground(DrawRange range)
 {
     glStencilFunc(GL_EQUAL, 1, 0xFF);
     glStencilMask(0x00);
@@ -327,31 +1173,9 @@ void ObjectInPathAnalyzer::renderForeground()
     RGBAColor color{};
     color.b = 1.0f;
     color.a = 0.5f;
-    auto uColor = glGetUniformLocation(programID_, "colorIn");
-    glUniform4fv(uColor, 1, reinterpret_cast<float32_t*>(&color));
-
-    GLuint vertexbuffer;
-    glGenBuffers(1, &vertexbuffer);
-    glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer);
-    glBufferData(GL_ARRAY_BUFFER, fgSize_ * 3 * sizeof(GLfloat), fgData_, GL_STATIC_DRAW);
-
-    // 1rst attribute buffer : vertices
-    glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer);
-    glVertexAttribPointer(
-        0,                  // attribute 0. No particular reason for 0, but must match the layout in the shader.
-        3,                  // size
-        GL_FLOAT,           // type
-        GL_FALSE,           // normalized?
-        0,                  // stride
-        (void*)0            // array buffer offset
-    );
+    setColor(color);
 
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4); // 3 indices starting at 0 -> 1 triangle
-
-    glDisableVertexAttribArray(0);
-
-    glDeleteBuffers(1, &vertexbuffer);
+    glDrawArrays(GL_TRIANGLE_STRIP, range.first, range.count);
 }
 
 void ObjectInPathAnalyzer::mockData()
@@ -379,46 +1203,14 @@ void ObjectInPathAnalyzer::mockData()
     fgSize_ = 4u;
 }
 
-std::vector<GLfloat> ObjectInPathAnalyzer::trivialObstacleTriangulation(const ObstacleData& obs)
-{
-    std::vector<GLfloat> ret{};
-
-    for (size_t i = 0u; i < 4u; ++i)
-    {
-        ret.push_back(obs.boundaryPoints.at(i).x);
-        ret.push_back(obs.boundaryPoints.at(i).y);
-        ret.push_back(obs.boundaryPoints.at(i).z);
-    }
-
-    return ret;
-}
 
-uint32_t ObjectInPathAnalyzer::renderObstacle(const std::vector<GLfloat>& vertexData, RGBAColor color)
+uint32_t ObjectInPathAnalyzer::renderObstacle(DrawRange range, RGBAColor color)
 {
-    auto uColor = glGetUniformLocation(programID_, "colorIn");
-    glUniform4fv(uColor, 1, reinterpret_cast<float32_t*>(&color));
-
     GLuint query;
     glGenQueries(1, &query);
     glBeginQuery(GL_SAMPLES_PASSED, query);
 
-    glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer_);
-    glBufferData(GL_ARRAY_BUFFER, vertexData.size() * sizeof(GLfloat), &vertexData[0], GL_STATIC_DRAW);
-
-    // 1rst attribute buffer : vertices
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(
-        0,                  // attribute 0. No particular reason for 0, but must match the layout in the shader.
-        3,                  // size
-        GL_FLOAT,           // type
-        GL_FALSE,           // normalized?
-        0,                  // stride
-        (void*)0            // array buffer offset
-    );
-
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4); // 3 indices starting at 0 -> 1 triangle
-
-    glDisableVertexAttribArray(0);
+    drawObstacle(range, color);
 
     glEndQuery(GL_SAMPLES_PASSED);
 
@@ -435,122 +1227,24 @@ uint32_t ObjectInPathAnalyzer::renderObstacle(const std::vector<GLfloat>& vertex
     return static_cast<uint32_t>(pixelCount);
 }
 
-
-std::vector<GLfloat> ObjectInPathAnalyzer::trivialLaneTriangulation(const LaneData& lane)
+void ObjectInPathAnalyzer::drawObstacle(DrawRange range, RGBAColor color)
 {
-    // check lane data matches the expectation
-    if (lane.leftDiv.size() != lane.rightDiv.size())
-    {
-        throw std::runtime_error("left and right divider sizes do not match.\n");
-    }
-
-    std::vector<GLfloat> ret{};
-
-    for (size_t i = 0u; i + 1 < lane.leftDiv.size(); ++i)
-    {
-        ret.push_back(lane.leftDiv[i].x);
-        ret.push_back(lane.leftDiv[i].y);
-        ret.push_back(lane.leftDiv[i].z);
-
-        ret.push_back(lane.leftDiv[i + 1].x);
-        ret.push_back(lane.leftDiv[i + 1].y);
-        ret.push_back(lane.leftDiv[i + 1].z);
-
-        ret.push_back(lane.rightDiv[i].x);
-        ret.push_back(lane.rightDiv[i].y);
-        ret.push_back(lane.rightDiv[i].z);
-
-        ret.push_back(lane.leftDiv[i + 1].x);
-        ret.push_back(lane.leftDiv[i + 1].y);
-        ret.push_back(lane.leftDiv[i + 1].z);
-
-        ret.push_back(lane.rightDiv[i].x);
-        ret.push_back(lane.rightDiv[i].y);
-        ret.push_back(lane.rightDiv[i].z);
-
-        ret.push_back(lane.rightDiv[i + 1].x);
-        ret.push_back(lane.rightDiv[i + 1].y);
-        ret.push_back(lane.rightDiv[i + 1].z);
-    }
-
-    return ret;
+    setColor(color);
+    glDrawArrays(GL_TRIANGLES, range.first, range.count);
 }
 
-void ObjectInPathAnalyzer::renderLane(const std::vector<GLfloat>& vertexData, RGBAColor color)
-{
-    auto uColor = glGetUniformLocation(programID_, "colorIn");
-    glUniform4fv(uColor, 1, reinterpret_cast<float32_t*>(&color));
-
-    glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer_);
-    glBufferData(GL_ARRAY_BUFFER, vertexData.size() * sizeof(GLfloat), &vertexData[0], GL_STATIC_DRAW);
-
-    // 1rst attribute buffer : vertices
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(
-        0,                  // attribute 0. No particular reason for 0, but must match the layout in the shader.
-        3,                  // size
-        GL_FLOAT,           // type
-        GL_FALSE,           // normalized?
-        0,                  // stride
-        (void*)0            // array buffer offset
-    );
-
-    glDrawArrays(GL_TRIANGLES, 0, vertexData.size());
-
-    glDisableVertexAttribArray(0);
-}
 
-
-std::vector<GLfloat> ObjectInPathAnalyzer::trivialFreespaceTriangulation(const FreespaceData& fs)
+void ObjectInPathAnalyzer::renderLane(DrawRange range, RGBAColor color)
 {
-    std::vector<GLfloat> ret{};
-
-    // output GL_TRIANGLE_FAN layout
-    // Indices:     0 1 2 3 4 5 ...
-    // Triangles:  {0 1 2}
-    //             {0} {2 3}
-    //             {0}   {3 4}
-    //             {0}     {4 5}
-    ret.push_back(0.0f);
-    ret.push_back(0.0f);
-    ret.push_back(0.0f);
-
-    for (size_t i = 0u; i < fs.data.size(); ++i)
-    {
-        Point3f v1 = {.x = std::cos(fs.data.at(i).first) * fs.data.at(i).second,
-                      .y = std::sin(fs.data.at(i).first) * fs.data.at(i).second,
-                      .z = 0.0f};
-
-        ret.push_back(v1.x);
-        ret.push_back(v1.y);
-        ret.push_back(v1.z);
-    }
-
-    return ret;
+    setColor(color);
+    glDrawArrays(GL_TRIANGLES, range.first, range.count);
 }
 
-void ObjectInPathAnalyzer::renderFreespace(const std::vector<GLfloat>& vertexData, RGBAColor color)
-{
-    auto uColor = glGetUniformLocation(programID_, "colorIn");
-    glUniform4fv(uColor, 1, reinterpret_cast<float32_t*>(&color));
-
-    glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer_);
-    glBufferData(GL_ARRAY_BUFFER, vertexData.size() * sizeof(GLfloat), &vertexData[0], GL_STATIC_DRAW);
 
-    // 1rst attribute buffer : vertices
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(
-        0,                  // attribute 0. No particular reason for 0, but must match the layout in the shader.
-        3,                  // size
-        GL_FLOAT,           // type
-        GL_FALSE,           // normalized?
-        0,                  // stride
-        (void*)0            // array buffer offset
-    );
-
-    glDrawArrays(GL_TRIANGLE_FAN, 0, vertexData.size());
-
-    glDisableVertexAttribArray(0);
+void ObjectInPathAnalyzer::renderFreespace(DrawRange range, RGBAColor color)
+{
+    setColor(color);
+    glDrawArrays(GL_TRIANGLE_FAN, range.first, range.count);
 }
 
 RGBColor ObjectInPathAnalyzer::getNextColor()
@@ -9,15 +9,14 @@
 #include <vector>
 #include <utility> // pair
 
-using float32_t = float;
-using float64_t = double;
-template<typename T>
-struct Point3
-{
-    T x{0.0};
-    T y{0.0};
-    T z{0.0};
-};
+#include "ObjectInPathAnalyzerBase.hpp"
+#include "VertexArena.hpp"
+#include "FrameArena.hpp"
+#include "LaneCache.hpp"
+#include "CoveragePyramid.hpp"
+#include "ObstacleCache.hpp"
+#include "FreespaceBuilder.hpp"
+#include "StageTrace.hpp"
 
 struct RGBColor
 {
@@ -54,62 +53,82 @@ static const RGBColor COLOR_SET[] =
     CYAN
 };
 
-using Point3f = Point3<float32_t>;
-using Point3d = Point3<float64_t>;
-
-struct LaneData
-{
-    std::vector<Point3f> leftDiv;
-    std::vector<Point3f> rightDiv;  // assume left and right dividers have the same size
-    uint32_t id;    // assume each lane has a unique id
-};
-
-struct ObstacleData
+// strategy used by the lane assignment
+enum class LaneAssignmentMode
 {
-    std::vector<Point3f> boundaryPoints{};  // assume 4 vertices. 0-1-2 and 1-2-3 form 2 triangles which cover the total area
-    uint32_t id;    // assume each obstacle has a unique id
+    PER_LANE,   // one stencil clear per lane, one blocking query per lane/obstacle pair
+    BATCHED,    // up to 8 lanes share the stencil buffer (one bit each), all queries are read back once
+    LANE_MASK   // all lanes are ORed into an integer lane mask in one pass (32 lanes per layer), kept while
+                // neither the lanes nor the view change. Pairs test their lane bit, all queries are read back once
 };
 
-struct FreespaceData
-{
-    std::vector<std::pair<float32_t, float32_t>> data;
-};
-
-// output data type
-struct LaneAssignmentData
-{
-    uint32_t obstacleId;
-    std::vector<uint32_t> laneIds;
-    std::vector<uint32_t> intersectionPixelCounts;
-    uint32_t obstacleTotalPixelCount;
-    std::vector<GLfloat> obstacleVertexData{};
-};
+// identifies a frame submitted with ObjectInPathAnalyzer::submit()
+using FrameTicket = uint64_t;
 
-class ObjectInPathAnalyzer
+class ObjectInPathAnalyzer : public ObjectInPathAnalyzerBase
 {
 public: 
-    ObjectInPathAnalyzer();
+    explicit ObjectInPathAnalyzer(const RasterConfig& config = RasterConfig{});
     ~ObjectInPathAnalyzer();
 
     // [optional] get the framebuffer to be renderred in a glfw window, for debugging purpose
     unsigned int getFramebuffer() const {return fbo_;};
 
+    // view of the last call, its pixels are [0, width) x [0, height) of the framebuffer
+    const RasterView& getRasterView() const {return view_;};
+
     // illustration
     void process(); 
 
+    using ObjectInPathAnalyzerBase::process;
+
     // process lane assignment
-    void process(const std::vector<LaneData>& lanes, const std::vector<ObstacleData>& obstacles);
+    void process(const std::vector<LaneView>& lanes,
+                 const std::vector<ObstacleView>& obstacles,
+                 std::vector<LaneAssignmentData>& result) override;
+
+    void setLaneAssignmentMode(LaneAssignmentMode mode) {laneAssignmentMode_ = mode;};
+    LaneAssignmentMode getLaneAssignmentMode() const {return laneAssignmentMode_;};
+
+    // pipelined lane assignment: render a frame (BATCHED, or LANE_MASK in that mode) without waiting for its query results
+    // tickets start at 0 and increase by one per submitted frame
+    FrameTicket submit(const std::vector<LaneView>& lanes, const std::vector<ObstacleView>& obstacles);
+    FrameTicket submit(const std::vector<LaneData>& lanes, const std::vector<ObstacleData>& obstacles);
+
+    // get the result of the oldest submitted frame, in submission order
+    // returns false if that frame is not finished on the GPU yet, unless "wait" is set
+    // "result" is swapped with the internal storage, so passing the same vector every frame allocates nothing
+    bool harvest(FrameTicket& ticket, std::vector<LaneAssignmentData>& result, bool wait = false);
+
+    // number of submitted frames which have not been harvested yet
+    size_t getFramesInFlight() const {return framesInFlight_;};
+
+    // per-stage timings of the lane assignment calls into getStageTrace(), off by default
+    // CPU stages are steady clock spans, GPU stages GL_TIME_ELAPSED timer queries which are collected once the
+    // frame is read back, i.e. at the end of process() or by harvest()
+    void setProfiling(bool enabled) {profiling_ = enabled;};
+    bool isProfiling() const {return profiling_;};
+    const StageTrace& getStageTrace() const {return stageTrace_;};
+
+    void process(const FreespaceBeams& freespace,
+                 const std::vector<ObstacleData>& obstacles,
+                 const std::vector<ObstacleData>& querys,
+                 std::vector<QueryCollisionData>& result) override;
 
-    void process(const FreespaceData& freespace,
+    void process(const FreespaceBeams& freespace,
                  const std::vector<ObstacleData>& obstacles,
-                 const std::vector<ObstacleData>& querys);
+                 const std::vector<TrajectoryData>& trajectories,
+                 std::vector<TrajectoryCollisionData>& result) override;
 
 private:
     /**** framebuffer ****/
 
-    // create a framebuffer
+    // create a framebuffer of fbWidth_ x fbHeight_
     void createFramebuffer();
 
+    // grow the framebuffer to at least width x height
+    void resizeFramebuffer(uint32_t width, uint32_t height);
+
     // release a framebuffer
     void releaseFramebuffer();
 
@@ -117,14 +136,37 @@ private:
     unsigned int colorTexture_; // attached to fbo_
     unsigned int depthTexture_; // attached to fbo_
 
-    // framebuffer dimension
-    static constexpr uint32_t WIN_W = 800;
-    static constexpr uint32_t WIN_H = 800;
+    // framebuffer dimension, a call only uses the part covered by its view
+    uint32_t fbWidth_;
+    uint32_t fbHeight_;
+
+    /**** view ****/
+    RasterView view_{};
+
+    // resize the framebuffer if needed, restrict viewport and scissor to the view and set the view transform
+    void setupView(const RasterView& view);
 
     /**** shader ****/
     GLuint programID_;
+    GLint colorLocation_{-1};   // location of the "colorIn" uniform
+    GLint viewLocation_{-1};    // location of the "viewTransform" uniform
     void loadShaders();
 
+    // programs of the LANE_MASK mode: lanes into the lane mask, obstacles tested against it
+    GLuint laneMaskProgramID_{0u};
+    GLint laneMaskViewLocation_{-1};
+    GLint laneMaskBitLocation_{-1};
+    GLuint laneTestProgramID_{0u};
+    GLint laneTestViewLocation_{-1};
+    GLint laneTestColorLocation_{-1};
+    GLint laneTestLayerLocation_{-1};
+    GLint laneTestBitLocation_{-1};
+
+    // set the view transform of view_ in the current program
+    void setViewTransform(GLint location);
+
+    void setColor(RGBAColor color);
+
     // clear all GL settings
     // call at the begining of each process function call
     void resetGLSettings();
@@ -136,7 +178,7 @@ private:
     size_t bgSize_;     // number of vertices
                         // number of triangles = bgSize_ - 2 because the layout is GL_TRIANGLE_STRIP
 
-    void renderBackground();
+    void renderBackground(DrawRange range);
 
     /**** foreground data ****/
     // foreground is obstacle for driving
@@ -144,29 +186,194 @@ private:
     GLfloat fgData_[100];
     size_t fgSize_;     // number of vertices
 
-    void renderForeground();
+    void renderForeground(DrawRange range);
 
     // for demonstration purpose
     void mockData();
 
-    GLuint vertexbuffer_;
-    /**** result ****/
-    std::vector<LaneAssignmentData> outputData_{};
+    /**** vertex data ****/
+    // every vertex of a frame is uploaded once, draws refer to it by range
+    VertexArena arena_{};
+    // triangulated vertex data of the current frame, before it is staged in arena_
+    FrameArena frameArena_{};
+    // polygon triangulations of the previous calls
+    ObstacleCache obstacleCache_{};
+    ObstacleCache queryCache_{};
+    // unit directions of the freespace beams
+    FreespaceBuilder freespaceBuilder_{};
+    // ranges of the current frame
+    std::vector<DrawRange> obstacleRanges_{};
+    std::vector<DrawRange> queryRanges_{};
+
+    /**** lane geometry ****/
+    // lanes are triangulated and uploaded only when they change, see LaneCache
+    LaneCache laneCache_{};
+    GLuint laneVao_{0u};
+    GLuint laneBuffer_{0u};
+    uint64_t laneBufferRevision_{0u};   // revision of laneCache_ in laneBuffer_, 0 if none
+    // ranges of the lanes in laneBuffer_
+    std::vector<DrawRange> laneRanges_{};
+
+    // update the cache with "lanes" and respecify laneBuffer_ and lanePyramid_ if it changed. Binds the VAO of arena_
+    void updateLaneBuffer(const std::vector<LaneView>& lanes);
+
+    // coarse lane coverage, rebuilt with laneBuffer_
+    CoveragePyramid lanePyramid_{};
+    // lanes which may overlap obstacle #i: lanePyramid_.getWordCount() words from i * lanePyramid_.getWordCount()
+    std::vector<uint64_t> laneCandidates_{};
+    // union of laneCandidates_ over every obstacle
+    std::vector<uint64_t> usedLanes_{};
+
+    // fill laneCandidates_ and usedLanes_ for the obstacle vertex data of "output"
+    void findLaneCandidates(const std::vector<LaneAssignmentData>& output);
+
+    /**** lane assignment ****/
+    LaneAssignmentMode laneAssignmentMode_{LaneAssignmentMode::PER_LANE};
+
+    // number of stencil bits, i.e. number of lanes rasterized per stencil clear in BATCHED mode
+    static constexpr uint32_t STENCIL_LANE_BITS = 8;
+
+    // lanes per layer of the lane mask in LANE_MASK mode
+    static constexpr uint32_t LANE_MASK_BITS = 32;
+
+    // stencil bits above the freespace bit, i.e. number of trajectories swept per stencil clear
+    static constexpr uint32_t STENCIL_SWEEP_BITS = 7;
+
+    void processPerLane(const std::vector<LaneView>& lanes,
+                        const std::vector<ObstacleView>& obstacles,
+                        std::vector<LaneAssignmentData>& result);
+
+    void processBatched(const std::vector<LaneView>& lanes,
+                        const std::vector<ObstacleView>& obstacles,
+                        std::vector<LaneAssignmentData>& result);
+
+    std::vector<uint32_t> laneIds_{};   // lane ids of the current call
+
+    // obstacle/lane pair which passed the lanePyramid_ test, i.e. got an intersection query
+    struct LanePair
+    {
+        uint32_t lane;
+        uint32_t obstacle;
+    };
+    std::vector<LanePair> lanePairs_{};     // pairs of the current call
+
+    // issue all BATCHED or LANE_MASK draws, one query of "queries" per draw. Returns the number of queries used
+    // "output" gets one element per obstacle, with empty lane lists. "pairs" gets the pairs which were
+    // queried, ordered by lane
+    size_t renderBatched(const std::vector<LaneView>& lanes,
+                         const std::vector<ObstacleView>& obstacles,
+                         std::vector<LaneAssignmentData>& output,
+                         std::vector<LanePair>& pairs,
+                         std::vector<GLuint>& queries);
+
+    // fill lane lists, pixel counts and areas of "output" from the query results of renderBatched()
+    void assignBatchedResults(const std::vector<uint32_t>& laneIds,
+                              const std::vector<LanePair>& pairs,
+                              const std::vector<GLuint>& results,
+                              float32_t pixelArea,
+                              std::vector<LaneAssignmentData>& output);
+
+    /**** lane mask (LANE_MASK mode) ****/
+    // GL_R32UI texture array of fbWidth_ x fbHeight_, bit j % 32 of layer j / 32 set where lane j covers the pixel
+    GLuint laneMaskTexture_{0u};
+    GLuint laneMaskFbo_{0u};    // draws into one layer of laneMaskTexture_
+    uint32_t laneMaskWidth_{0u};
+    uint32_t laneMaskHeight_{0u};
+    uint32_t laneMaskLayers_{0u};
+    // laneMaskTexture_ holds the lanes of this revision of laneCache_ in this view, 0 if invalid
+    uint64_t laneMaskRevision_{0u};
+    RasterView laneMaskView_{};
+
+    // rasterize the lanes of laneCache_ into laneMaskTexture_ unless it is still valid. Binds the VAO of arena_
+    void updateLaneMask();
+
+    // issue one query of "queries" per pair, from index "queryCount", counting the obstacle pixels with the
+    // lane bit set in laneMaskTexture_. Returns the number of queries used
+    size_t renderMaskedPairs(const std::vector<LanePair>& pairs, std::vector<GLuint>& queries, size_t queryCount);
+
+    /**** queries ****/
+    // GL_SAMPLES_PASSED query objects, generated on demand and reused across calls
+    std::vector<GLuint> queryPool_{};
+    // query results, filled by readQueryResults()
+    std::vector<GLuint> queryResults_{};
+    // GL_QUERY_BUFFER target for reading all results with a single download (0 if unsupported)
+    GLuint queryResultBuffer_{0u};
+    size_t queryResultBufferSize_{0u};
+
+    // make sure at least "count" query objects are available in "queries"
+    void reserveQueries(std::vector<GLuint>& queries, size_t count);
+
+    // read the results of the first "count" queries of "queries" into queryResults_
+    void readQueryResults(const std::vector<GLuint>& queries, size_t count);
+
+    void releaseQueries(std::vector<GLuint>& queries);
+
+    /**** pipeline ****/
+    // a frame submitted with submit(), waiting to be harvested
+    struct PendingFrame
+    {
+        FrameTicket ticket{0u};
+        bool inFlight{false};
+        std::vector<GLuint> queries{};  // owned by the frame, reused once it is harvested
+        size_t queryCount{0u};
+        std::vector<uint32_t> laneIds{};
+        std::vector<LanePair> lanePairs{};
+        float32_t pixelArea{0.0f};  // of the view the frame was rendered with
+        uint64_t traceFrame{0u};    // frame of its stage events
+        std::vector<LaneAssignmentData> result{};
+    };
+
+    // frames which can be in flight before a new slot has to be added
+    static constexpr size_t PIPELINE_DEPTH = 3;
+
+    std::vector<PendingFrame> pipeline_{};
+    FrameTicket nextTicket_{0u};
+    size_t framesInFlight_{0u};
+
+    /**** profiling ****/
+    bool profiling_{false};
+    StageTrace stageTrace_{};
+    uint64_t traceFrame_{0u};   // frame of the current call, counts every lane assignment call
+
+    // a GPU stage waiting for its timer query
+    struct GpuStageSpan
+    {
+        uint64_t frame;
+        Stage stage;
+        uint64_t issued;    // steady clock when its first draw was issued
+        GLuint query;
+    };
+    std::vector<GpuStageSpan> gpuStageSpans_{};     // in issue order
+    std::vector<GLuint> timerQueryPool_{};          // free GL_TIME_ELAPSED queries
+    bool gpuStageActive_{false};
+
+    // steady clock if profiling, 0 otherwise
+    uint64_t stageClock() const {return profiling_ ? StageTrace::now() : 0u;};
+
+    // record the CPU stage which began at "begin", returns the end of it
+    uint64_t recordCpuStage(Stage stage, uint64_t begin);
+
+    // time the draws up to the next endGpuStage(), at most one GPU stage is active at a time
+    void beginGpuStage(Stage stage);
+    void endGpuStage();
+
+    // record the GPU stages of the frames up to "frame", waiting for their timer queries, and those of later
+    // frames which are already available. A frame is recorded at once, one event per stage, the time of its
+    // spans summed up
+    void collectGpuStages(uint64_t frame);
 
     /**** render functions ****/
-    // assume that obs has 4 vertices. 0-1-2 and 1-2-3 form 2 triangles which cover the total area
-    std::vector<GLfloat> trivialObstacleTriangulation(const ObstacleData& obs);
-
-    uint32_t renderObstacle(const std::vector<GLfloat>& vertexData, RGBAColor color);
+    uint32_t renderObstacle(DrawRange range, RGBAColor color);
 
-    // assume left and right dividers have the same size
-    std::vector<GLfloat> trivialLaneTriangulation(const LaneData& lane);
+    // draw an obstacle without any occlusion query
+    void drawObstacle(DrawRange range, RGBAColor color);
 
-    void renderLane(const std::vector<GLfloat>& vertexData, RGBAColor color);
+    void renderLane(DrawRange range, RGBAColor color);
 
-    std::vector<GLfloat> trivialFreespaceTriangulation(const FreespaceData& fs);
+    void renderFreespace(DrawRange range, RGBAColor color);
 
-    void renderFreespace(const std::vector<GLfloat>& vertexData, RGBAColor colorData);
+    // stencil 1 inside the freespace and outside of the obstacles of obstacleRanges_, 0 elsewhere
+    void renderFreespaceMask(DrawRange fsRange);
 
     uint32_t currColor = 0;
     RGBColor getNextColor();
@@ -0,0 +1,67 @@
+#include "ObjectInPathAnalyzerBase.hpp"
+#include "FreespaceBuilder.hpp"
+#include <iostream>
+
+void ObjectInPathAnalyzerBase::process(const std::vector<LaneData>& lanes,
+                                       const std::vector<ObstacleData>& obstacles,
+                                       std::vector<LaneAssignmentData>& result)
+{
+    makeLaneViews(lanes, laneViews_);
+    makeObstacleViews(obstacles, obstacleViews_);
+    process(laneViews_, obstacleViews_, result);
+}
+
+void ObjectInPathAnalyzerBase::process(const std::vector<LaneData>& lanes,
+                                       const std::vector<ObstacleData>& obstacles)
+{
+    process(lanes, obstacles, outputData_);
+    printLaneAssignment(outputData_);
+}
+
+void ObjectInPathAnalyzerBase::process(const FreespaceData& freespace,
+                                       const std::vector<ObstacleData>& obstacles,
+                                       const std::vector<ObstacleData>& querys,
+                                       std::vector<QueryCollisionData>& result)
+{
+    process(makeFreespaceBeams(freespace), obstacles, querys, result);
+}
+
+void ObjectInPathAnalyzerBase::process(const FreespaceData& freespace,
+                                       const std::vector<ObstacleData>& obstacles,
+                                       const std::vector<TrajectoryData>& trajectories,
+                                       std::vector<TrajectoryCollisionData>& result)
+{
+    process(makeFreespaceBeams(freespace), obstacles, trajectories, result);
+}
+
+void ObjectInPathAnalyzerBase::process(const FreespaceData& freespace,
+                                       const std::vector<ObstacleData>& obstacles,
+                                       const std::vector<ObstacleData>& querys)
+{
+    process(freespace, obstacles, querys, collisionData_);
+    printQueryCollision(collisionData_);
+}
+
+void printLaneAssignment(const std::vector<LaneAssignmentData>& data)
+{
+    // summarizing the result
+    for (const LaneAssignmentData& elem : data)
+    {
+        for (size_t i = 0u; i < elem.laneIds.size(); ++i)
+        {
+            std::cout << "Obstacle #" << elem.obstacleId << " is lane assigned to lane #" << elem.laneIds.at(i) 
+                      << " for ratio " << elem.coverageRatios.at(i) << std::endl;
+        }
+    }
+}
+
+void printQueryCollision(const std::vector<QueryCollisionData>& data)
+{
+    for (const QueryCollisionData& elem : data)
+    {
+        if (elem.collision)
+        {
+            std::cout << "collision happened" << std::endl;
+        }
+    }
+}
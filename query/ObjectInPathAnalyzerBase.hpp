@@ -0,0 +1,90 @@
+#ifndef OBJECT_IN_PATH_ANALYZER_BASE_HPP
+#define OBJECT_IN_PATH_ANALYZER_BASE_HPP
+
+#include "QueryTypes.hpp"
+#include "InputView.hpp"
+#include "RasterView.hpp"
+
+// common interface of the ObjectInPathAnalyzer backends, so that a deployment can pick
+// the OpenGL one (ObjectInPathAnalyzer) or the one without any GL context (CpuObjectInPathAnalyzer)
+class ObjectInPathAnalyzerBase
+{
+public:
+    virtual ~ObjectInPathAnalyzerBase() = default;
+
+    // process lane assignment into "result", one element per obstacle in input order
+    // the viewed points are only read during the call
+    virtual void process(const std::vector<LaneView>& lanes,
+                         const std::vector<ObstacleView>& obstacles,
+                         std::vector<LaneAssignmentData>& result) = 0;
+
+    // same, viewing the elements of "lanes" and "obstacles"
+    void process(const std::vector<LaneData>& lanes,
+                 const std::vector<ObstacleData>& obstacles,
+                 std::vector<LaneAssignmentData>& result);
+
+    // process collision of the querys with the freespace minus the obstacles into "result",
+    // one element per query in input order
+    virtual void process(const FreespaceBeams& freespace,
+                         const std::vector<ObstacleData>& obstacles,
+                         const std::vector<ObstacleData>& querys,
+                         std::vector<QueryCollisionData>& result) = 0;
+
+    // same, with the (angle, range) pairs of "freespace" read in place
+    void process(const FreespaceData& freespace,
+                 const std::vector<ObstacleData>& obstacles,
+                 const std::vector<ObstacleData>& querys,
+                 std::vector<QueryCollisionData>& result);
+
+    // sweep the footprints of every trajectory through the freespace minus the obstacles into "result",
+    // one element per trajectory in input order. The freespace is rasterized once for all trajectories
+    virtual void process(const FreespaceBeams& freespace,
+                         const std::vector<ObstacleData>& obstacles,
+                         const std::vector<TrajectoryData>& trajectories,
+                         std::vector<TrajectoryCollisionData>& result) = 0;
+
+    // same, with the (angle, range) pairs of "freespace" read in place
+    void process(const FreespaceData& freespace,
+                 const std::vector<ObstacleData>& obstacles,
+                 const std::vector<TrajectoryData>& trajectories,
+                 std::vector<TrajectoryCollisionData>& result);
+
+    // process lane assignment into getLaneAssignmentData() and print it
+    void process(const std::vector<LaneData>& lanes, const std::vector<ObstacleData>& obstacles);
+
+    // process collision into getQueryCollisionData() and print the collisions
+    void process(const FreespaceData& freespace,
+                 const std::vector<ObstacleData>& obstacles,
+                 const std::vector<ObstacleData>& querys);
+
+    // result of the last printing lane assignment
+    const std::vector<LaneAssignmentData>& getLaneAssignmentData() const {return outputData_;};
+
+    // result of the last printing collision check
+    const std::vector<QueryCollisionData>& getQueryCollisionData() const {return collisionData_;};
+
+    // resolution of the following calls. In adaptive mode the rasterized region is the bounding box
+    // of the obstacles (lane assignment) or of the querys (freespace): only their pixels are counted
+    void setRasterConfig(const RasterConfig& config) {rasterConfig_ = config;};
+    const RasterConfig& getRasterConfig() const {return rasterConfig_;};
+
+protected:
+    RasterConfig rasterConfig_{};
+
+    // views of the last LaneData/ObstacleData call, kept to avoid allocations
+    std::vector<LaneView> laneViews_{};
+    std::vector<ObstacleView> obstacleViews_{};
+
+    /**** result ****/
+    std::vector<LaneAssignmentData> outputData_{};
+    std::vector<QueryCollisionData> collisionData_{};
+
+}; // class ObjectInPathAnalyzerBase
+
+// print which lanes each obstacle is assigned to, and for which ratio of its area
+void printLaneAssignment(const std::vector<LaneAssignmentData>& data);
+
+// print a line per colliding query
+void printQueryCollision(const std::vector<QueryCollisionData>& data);
+
+#endif // OBJECT_IN_PATH_ANALYZER_BASE_HPP
@@ -0,0 +1,62 @@
+#include "ObstacleCache.hpp"
+#include "Triangulation.hpp"
+#include "GeometryHash.hpp"
+#include <algorithm> // std::copy
+
+uint64_t ObstacleCache::hash(const ObstacleView& obs)
+{
+    uint64_t h = hashPoints(GEOMETRY_HASH_SEED, obs.boundaryPoints);
+    for (size_t k = 0u; k < obs.holeCount; ++k)
+    {
+        h = hashPoints(h, obs.getHole(k));
+    }
+    return h;
+}
+
+void ObstacleCache::beginFrame()
+{
+    ++frame_;
+    rebuildCount_ = 0u;
+
+    for (auto it = entries_.begin(); it != entries_.end();)
+    {
+        if (frame_ - it->second.lastFrame > maxIdleFrames_)
+        {
+            it = entries_.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+VertexSpan ObstacleCache::triangulate(const ObstacleView& obs, FrameArena& arena)
+{
+    if (obs.shape != ObstacleShape::POLYGON)
+    {
+        return trivialObstacleTriangulation(obs, arena);
+    }
+
+    const uint64_t obsHash = hash(obs);
+    auto it = entries_.find(obs.id);
+    if (it != entries_.end() && it->second.hash == obsHash)
+    {
+        Entry& entry = it->second;
+        entry.lastFrame = frame_;
+
+        VertexSpan ret = arena.allocate(entry.vertexData.size());
+        std::copy(entry.vertexData.begin(), entry.vertexData.end(), ret.data);
+        return ret;
+    }
+
+    VertexSpan ret = polygonObstacleTriangulation(obs, arena);
+    ++rebuildCount_;
+
+    Entry& entry = entries_[obs.id];
+    entry.hash = obsHash;
+    entry.lastFrame = frame_;
+    entry.vertexData.assign(ret.begin(), ret.end());
+
+    return ret;
+}
@@ -0,0 +1,48 @@
+#ifndef OBSTACLE_CACHE_HPP
+#define OBSTACLE_CACHE_HPP
+
+#include "InputView.hpp"
+#include "FrameArena.hpp"
+#include <unordered_map>
+
+// obstacle triangulations kept across calls, keyed by ObstacleData::id
+// a POLYGON obstacle is only triangulated again if its id is new or the hash of its outline and holes
+// changed. QUAD obstacles are cheaper to triangulate than to hash, they bypass the cache.
+// Entries which were not used during maxIdleFrames frames are dropped
+class ObstacleCache
+{
+public:
+    explicit ObstacleCache(uint32_t maxIdleFrames = 8u) : maxIdleFrames_(maxIdleFrames) {};
+
+    // start a frame, i.e. a process call, and drop idle entries
+    void beginFrame();
+
+    // GL_TRIANGLES vertex data of "obs", in "arena"
+    VertexSpan triangulate(const ObstacleView& obs, FrameArena& arena);
+    VertexSpan triangulate(const ObstacleData& obs, FrameArena& arena) {return triangulate(makeObstacleView(obs), arena);};
+
+    // POLYGON obstacles triangulated since the last beginFrame()
+    size_t getRebuildCount() const {return rebuildCount_;};
+
+    // number of cached obstacles
+    size_t size() const {return entries_.size();};
+
+    // content hash of the outline and the holes
+    static uint64_t hash(const ObstacleView& obs);
+
+private:
+    struct Entry
+    {
+        uint64_t hash{0u};
+        uint64_t lastFrame{0u};     // last frame which used the entry
+        std::vector<float32_t> vertexData{};
+    };
+
+    std::unordered_map<uint32_t, Entry> entries_{};
+    uint32_t maxIdleFrames_;
+    uint64_t frame_{0u};
+    size_t rebuildCount_{0u};
+
+}; // class ObstacleCache
+
+#endif // OBSTACLE_CACHE_HPP
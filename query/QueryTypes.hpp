@@ -0,0 +1,102 @@
+#ifndef QUERY_TYPES_HPP
+#define QUERY_TYPES_HPP
+
+// input and output data types shared by every ObjectInPathAnalyzer backend
+// this header must not depend on OpenGL, so that the CPU backend builds without it
+
+// Include standard headers
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <utility> // pair
+
+using float32_t = float;
+using float64_t = double;
+template<typename T>
+struct Point3
+{
+    T x{0.0};
+    T y{0.0};
+    T z{0.0};
+};
+
+using Point3f = Point3<float32_t>;
+using Point3d = Point3<float64_t>;
+
+struct LaneData
+{
+    std::vector<Point3f> leftDiv;
+    std::vector<Point3f> rightDiv;  // assume left and right dividers have the same size
+    uint32_t id;    // assume each lane has a unique id
+};
+
+enum class ObstacleShape
+{
+    QUAD,       // 4 boundary points. 0-1-2 and 1-2-3 form 2 triangles which cover the total area
+    POLYGON     // outline of a simple polygon with any number of points, in either orientation
+};
+
+struct ObstacleData
+{
+    std::vector<Point3f> boundaryPoints{};
+    std::vector<std::vector<Point3f>> holes{};  // POLYGON only, simple polygons strictly inside the outline
+    ObstacleShape shape{ObstacleShape::QUAD};
+    uint32_t id;    // assume each obstacle has a unique id
+};
+
+struct FreespaceData
+{
+    std::vector<std::pair<float32_t, float32_t>> data;
+};
+
+// freespace of a sensor, read in place from the sensor's buffers
+// beam i points along angles[i * angleStride] (radians) and is free up to ranges[i * rangeStride]
+struct FreespaceBeams
+{
+    const float32_t* angles{nullptr};
+    const float32_t* ranges{nullptr};
+    size_t count{0u};
+    size_t angleStride{1u};     // in floats
+    size_t rangeStride{1u};     // in floats
+};
+
+// candidate ego path, e.g. of a parking manoeuvre
+struct TrajectoryData
+{
+    std::vector<ObstacleData> footprints{};     // ego footprint at every pose, in driving order
+    uint32_t id;
+};
+
+// output data types
+// the analyzers refill them in place: vectors are cleared, never shrunk, so a result which is passed
+// to every call stops allocating once it reached the size of the largest frame
+struct LaneAssignmentData
+{
+    uint32_t obstacleId;
+    std::vector<uint32_t> laneIds;
+    std::vector<uint32_t> intersectionPixelCounts;   // only filled by rasterizing backends
+    uint32_t obstacleTotalPixelCount;
+    std::vector<float32_t> intersectionAreas;   // in square world units, one per lane id
+    std::vector<float32_t> coverageRatios;      // intersection area / obstacle total area, one per lane id
+    float32_t obstacleTotalArea;
+    std::vector<float32_t> obstacleVertexData{};    // GL_TRIANGLES layout
+};
+
+struct QueryCollisionData
+{
+    uint32_t queryId;
+    bool collision;                 // part of the query is outside the freespace or on an obstacle
+    uint32_t collisionPixelCount;   // pixels of that part
+    float32_t collisionArea;        // in square world units
+};
+
+struct TrajectoryCollisionData
+{
+    uint32_t trajectoryId;
+    bool collision;                 // the swept footprints leave the freespace or hit an obstacle
+    uint32_t collisionPixelCount;   // pixels of the swept volume in collision, each counted once
+    float32_t collisionArea;        // in square world units
+    int32_t firstCollidingPose;     // index of the first colliding footprint, -1 without collision
+};
+
+#endif // QUERY_TYPES_HPP
@@ -0,0 +1,120 @@
+#include "RasterView.hpp"
+#include <algorithm> // std::min std::max
+#include <cmath> // std::ceil
+
+namespace
+{
+
+// grow "roi" to "points". "empty" is set while roi holds no point yet
+void extendRegion(const PointArray& points, RegionOfInterest& roi, bool& empty)
+{
+    for (size_t i = 0u; i < points.size(); ++i)
+    {
+        const Point3f p = points[i];
+        if (empty)
+        {
+            roi.minX = roi.maxX = p.x;
+            roi.minY = roi.maxY = p.y;
+            empty = false;
+        }
+        roi.minX = std::min(roi.minX, p.x);
+        roi.maxX = std::max(roi.maxX, p.x);
+        roi.minY = std::min(roi.minY, p.y);
+        roi.maxY = std::max(roi.maxY, p.y);
+    }
+}
+
+// grow "roi" to the boundary points of "elements"
+void extendRegion(const std::vector<ObstacleData>& elements, RegionOfInterest& roi, bool& empty)
+{
+    for (const ObstacleData& element : elements)
+    {
+        extendRegion(makePointArray(element.boundaryPoints), roi, empty);
+    }
+}
+
+// adaptive view of the fitted "roi", config.roi if nothing was fitted
+RasterView fitRasterView(const RasterConfig& config, RegionOfInterest roi, bool empty)
+{
+    if (empty)
+    {
+        return makeRasterView(config, config.roi);
+    }
+
+    roi.minX -= config.adaptiveMargin;
+    roi.minY -= config.adaptiveMargin;
+    roi.maxX += config.adaptiveMargin;
+    roi.maxY += config.adaptiveMargin;
+
+    return makeRasterView(config, roi);
+}
+
+} // namespace
+
+RasterView makeRasterView(const RasterConfig& config, const RegionOfInterest& roi)
+{
+    // computed in double, so that a region which is a multiple of the resolution is not rounded up
+    const float64_t sizeX = std::max<float64_t>(roi.maxX - roi.minX, config.metresPerPixel);
+    const float64_t sizeY = std::max<float64_t>(roi.maxY - roi.minY, config.metresPerPixel);
+
+    float64_t metresPerPixel = config.metresPerPixel;
+    metresPerPixel = std::max(metresPerPixel, sizeX / std::max(config.maxWidth, 1u));
+    metresPerPixel = std::max(metresPerPixel, sizeY / std::max(config.maxHeight, 1u));
+
+    RasterView view{};
+    view.originX = roi.minX;
+    view.originY = roi.minY;
+    view.metresPerPixel = static_cast<float32_t>(metresPerPixel);
+    view.width = std::max(1u, static_cast<uint32_t>(std::ceil(sizeX / metresPerPixel)));
+    view.height = std::max(1u, static_cast<uint32_t>(std::ceil(sizeY / metresPerPixel)));
+
+    return view;
+}
+
+RasterView makeRasterView(const RasterConfig& config, const std::vector<ObstacleData>& elements)
+{
+    if (!config.adaptive)
+    {
+        return makeRasterView(config, config.roi);
+    }
+
+    bool empty = true;
+    RegionOfInterest roi{};
+    extendRegion(elements, roi, empty);
+
+    return fitRasterView(config, roi, empty);
+}
+
+RasterView makeRasterView(const RasterConfig& config, const std::vector<ObstacleView>& elements)
+{
+    if (!config.adaptive)
+    {
+        return makeRasterView(config, config.roi);
+    }
+
+    bool empty = true;
+    RegionOfInterest roi{};
+    for (const ObstacleView& element : elements)
+    {
+        extendRegion(element.boundaryPoints, roi, empty);
+    }
+
+    return fitRasterView(config, roi, empty);
+}
+
+RasterView makeRasterView(const RasterConfig& config, const std::vector<TrajectoryData>& trajectories)
+{
+    if (!config.adaptive)
+    {
+        return makeRasterView(config, config.roi);
+    }
+
+    bool empty = true;
+    RegionOfInterest roi{};
+    for (const TrajectoryData& trajectory : trajectories)
+    {
+        extendRegion(trajectory.footprints, roi, empty);
+    }
+
+    return fitRasterView(config, roi, empty);
+}
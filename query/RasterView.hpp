@@ -0,0 +1,65 @@
+#ifndef RASTER_VIEW_HPP
+#define RASTER_VIEW_HPP
+
+#include "InputView.hpp"
+
+// axis aligned world region, in metres
+struct RegionOfInterest
+{
+    float32_t minX{-50.0f};
+    float32_t minY{-50.0f};
+    float32_t maxX{50.0f};
+    float32_t maxY{50.0f};
+};
+
+// resolution settings of the rasterizing backends
+// the default covers [-50 m, 50 m]^2 with 800 x 800 pixels, i.e. 8 pixels per metre
+struct RasterConfig
+{
+    RegionOfInterest roi{};             // rasterized region, unless adaptive is set
+    float32_t metresPerPixel{0.125f};   // requested resolution
+    bool adaptive{false};               // fit the region to the counted geometry of every call
+    float32_t adaptiveMargin{0.5f};     // metres added around the fitted region
+    uint32_t maxWidth{4096u};           // the resolution is coarsened if the region needs more pixels
+    uint32_t maxHeight{4096u};
+};
+
+// mapping from world coordinates to framebuffer pixels used by one call
+struct RasterView
+{
+    float32_t originX{-50.0f};  // world position of the lower left corner of pixel (0, 0)
+    float32_t originY{-50.0f};
+    float32_t metresPerPixel{0.125f};
+    uint32_t width{800u};       // pixels
+    uint32_t height{800u};
+
+    // area of a pixel in square metres
+    float32_t getPixelArea() const {return metresPerPixel * metresPerPixel;};
+
+    // world to normalized device coordinates: ndc = world * scale + offset
+    float32_t getScaleX() const {return 2.0f / (metresPerPixel * static_cast<float32_t>(width));};
+    float32_t getScaleY() const {return 2.0f / (metresPerPixel * static_cast<float32_t>(height));};
+    float32_t getOffsetX() const {return -1.0f - originX * getScaleX();};
+    float32_t getOffsetY() const {return -1.0f - originY * getScaleY();};
+
+    // same pixels at the same world positions
+    bool operator==(const RasterView& other) const
+    {
+        return originX == other.originX && originY == other.originY && metresPerPixel == other.metresPerPixel &&
+               width == other.width && height == other.height;
+    };
+    bool operator!=(const RasterView& other) const {return !(*this == other);};
+};
+
+// view of "roi" at the resolution of "config", coarsened to fit config.maxWidth x config.maxHeight
+RasterView makeRasterView(const RasterConfig& config, const RegionOfInterest& roi);
+
+// view of a call whose pixel counts only depend on "elements":
+// config.roi, or in adaptive mode the bounding box of "elements" (config.roi if there is none)
+RasterView makeRasterView(const RasterConfig& config, const std::vector<ObstacleData>& elements);
+RasterView makeRasterView(const RasterConfig& config, const std::vector<ObstacleView>& elements);
+
+// same, fitted to the footprints of every trajectory in adaptive mode
+RasterView makeRasterView(const RasterConfig& config, const std::vector<TrajectoryData>& trajectories);
+
+#endif // RASTER_VIEW_HPP
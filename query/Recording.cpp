@@ -0,0 +1,377 @@
+#include "Recording.hpp"
+#include "FreespaceBuilder.hpp"
+#include <algorithm> // std::equal
+#include <stdexcept>
+#include <utility> // std::move
+
+namespace
+{
+
+const char RECORDING_MAGIC[4] = {'O', 'I', 'P', 'R'};
+constexpr uint32_t RECORDING_VERSION = 1u;
+
+} // namespace
+
+RecordingWriter::RecordingWriter(const std::string& path)
+    : file_(path, std::ios::binary | std::ios::trunc)
+{
+    if (!file_)
+    {
+        throw std::runtime_error("cannot open recording " + path + "\n");
+    }
+    file_.write(RECORDING_MAGIC, sizeof(RECORDING_MAGIC));
+    writeU32(RECORDING_VERSION);
+    file_.flush();
+    if (!file_)
+    {
+        throw std::runtime_error("cannot write recording " + path + "\n");
+    }
+}
+
+void RecordingWriter::write(const RecordedFrame& frame)
+{
+    switch (frame.call)
+    {
+    case RecordedCall::LANE_ASSIGNMENT:
+        writeLaneAssignment(frame.lanes, frame.obstacles);
+        break;
+    case RecordedCall::FREESPACE_QUERY:
+        writeFreespaceQuery(makeFreespaceBeams(frame.freespace), frame.obstacles, frame.querys);
+        break;
+    case RecordedCall::TRAJECTORY_SWEEP:
+        writeTrajectorySweep(makeFreespaceBeams(frame.freespace), frame.obstacles, frame.trajectories);
+        break;
+    }
+}
+
+void RecordingWriter::writeLaneAssignment(const std::vector<LaneData>& lanes, const std::vector<ObstacleData>& obstacles)
+{
+    writeU32(static_cast<uint32_t>(RecordedCall::LANE_ASSIGNMENT));
+    writeU32(static_cast<uint32_t>(lanes.size()));
+    for (const LaneData& lane : lanes)
+    {
+        writeLane(makeLaneView(lane));
+    }
+    writeObstacles(obstacles);
+    endFrame();
+}
+
+void RecordingWriter::writeLaneAssignment(const std::vector<LaneView>& lanes, const std::vector<ObstacleView>& obstacles)
+{
+    writeU32(static_cast<uint32_t>(RecordedCall::LANE_ASSIGNMENT));
+    writeU32(static_cast<uint32_t>(lanes.size()));
+    for (const LaneView& lane : lanes)
+    {
+        writeLane(lane);
+    }
+    writeU32(static_cast<uint32_t>(obstacles.size()));
+    for (const ObstacleView& obs : obstacles)
+    {
+        writeObstacle(obs);
+    }
+    endFrame();
+}
+
+void RecordingWriter::writeFreespaceQuery(const FreespaceBeams& freespace,
+                                          const std::vector<ObstacleData>& obstacles,
+                                          const std::vector<ObstacleData>& querys)
+{
+    writeU32(static_cast<uint32_t>(RecordedCall::FREESPACE_QUERY));
+    writeFreespace(freespace);
+    writeObstacles(obstacles);
+    writeObstacles(querys);
+    endFrame();
+}
+
+void RecordingWriter::writeTrajectorySweep(const FreespaceBeams& freespace,
+                                           const std::vector<ObstacleData>& obstacles,
+                                           const std::vector<TrajectoryData>& trajectories)
+{
+    writeU32(static_cast<uint32_t>(RecordedCall::TRAJECTORY_SWEEP));
+    writeFreespace(freespace);
+    writeObstacles(obstacles);
+    writeTrajectories(trajectories);
+    endFrame();
+}
+
+void RecordingWriter::writeU32(uint32_t value)
+{
+    file_.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void RecordingWriter::writePoints(const PointArray& points)
+{
+    writeU32(static_cast<uint32_t>(points.size()));
+    for (size_t i = 0u; i < points.size(); ++i)
+    {
+        const Point3f p = points[i];
+        const float32_t xyz[3] = {p.x, p.y, p.z};
+        file_.write(reinterpret_cast<const char*>(xyz), sizeof(xyz));
+    }
+}
+
+void RecordingWriter::writeLane(const LaneView& lane)
+{
+    writeU32(lane.id);
+    writePoints(lane.leftDiv);
+    writePoints(lane.rightDiv);
+}
+
+void RecordingWriter::writeObstacle(const ObstacleView& obs)
+{
+    writeU32(obs.id);
+    writeU32(static_cast<uint32_t>(obs.shape));
+    writePoints(obs.boundaryPoints);
+    writeU32(static_cast<uint32_t>(obs.holeCount));
+    for (size_t k = 0u; k < obs.holeCount; ++k)
+    {
+        writePoints(obs.getHole(k));
+    }
+}
+
+void RecordingWriter::writeObstacles(const std::vector<ObstacleData>& obstacles)
+{
+    writeU32(static_cast<uint32_t>(obstacles.size()));
+    for (const ObstacleData& obs : obstacles)
+    {
+        writeObstacle(makeObstacleView(obs));
+    }
+}
+
+void RecordingWriter::writeFreespace(const FreespaceBeams& freespace)
+{
+    writeU32(static_cast<uint32_t>(freespace.count));
+    for (size_t i = 0u; i < freespace.count; ++i)
+    {
+        const float32_t beam[2] = {freespace.angles[i * freespace.angleStride], freespace.ranges[i * freespace.rangeStride]};
+        file_.write(reinterpret_cast<const char*>(beam), sizeof(beam));
+    }
+}
+
+void RecordingWriter::writeTrajectories(const std::vector<TrajectoryData>& trajectories)
+{
+    writeU32(static_cast<uint32_t>(trajectories.size()));
+    for (const TrajectoryData& trajectory : trajectories)
+    {
+        writeU32(trajectory.id);
+        writeObstacles(trajectory.footprints);
+    }
+}
+
+void RecordingWriter::endFrame()
+{
+    // a crash of the recorded process keeps every complete frame
+    file_.flush();
+    if (!file_)
+    {
+        throw std::runtime_error("cannot write recording frame\n");
+    }
+    ++frameCount_;
+}
+
+RecordingReader::RecordingReader(const std::string& path)
+    : file_(path, std::ios::binary | std::ios::ate)
+{
+    if (!file_)
+    {
+        throw std::runtime_error("cannot open recording " + path + "\n");
+    }
+    remaining_ = static_cast<uint64_t>(file_.tellg());
+    file_.seekg(0);
+
+    char magic[sizeof(RECORDING_MAGIC)];
+    if (remaining_ < sizeof(magic) + sizeof(uint32_t))
+    {
+        throw std::runtime_error(path + " is not a recording\n");
+    }
+    readBytes(magic, sizeof(magic));
+    if (!std::equal(magic, magic + sizeof(magic), RECORDING_MAGIC))
+    {
+        throw std::runtime_error(path + " is not a recording\n");
+    }
+    if (readU32() != RECORDING_VERSION)
+    {
+        throw std::runtime_error("unsupported version of recording " + path + "\n");
+    }
+}
+
+bool RecordingReader::read(RecordedFrame& frame)
+{
+    if (remaining_ == 0u)
+    {
+        return false;
+    }
+
+    const uint32_t call = readU32();
+    frame.call = static_cast<RecordedCall>(call);
+    frame.lanes.clear();
+    frame.obstacles.clear();
+    frame.freespace.data.clear();
+    frame.querys.clear();
+    frame.trajectories.clear();
+    switch (frame.call)
+    {
+    case RecordedCall::LANE_ASSIGNMENT:
+        readLanes(frame.lanes);
+        readObstacles(frame.obstacles);
+        break;
+    case RecordedCall::FREESPACE_QUERY:
+        readFreespace(frame.freespace);
+        readObstacles(frame.obstacles);
+        readObstacles(frame.querys);
+        break;
+    case RecordedCall::TRAJECTORY_SWEEP:
+        readFreespace(frame.freespace);
+        readObstacles(frame.obstacles);
+        readTrajectories(frame.trajectories);
+        break;
+    default:
+        throw std::runtime_error("corrupt recording: unknown call " + std::to_string(call) + "\n");
+    }
+
+    return true;
+}
+
+std::vector<RecordedFrame> RecordingReader::readAll()
+{
+    std::vector<RecordedFrame> frames{};
+    RecordedFrame frame{};
+    while (read(frame))
+    {
+        frames.push_back(std::move(frame));
+    }
+
+    return frames;
+}
+
+uint32_t RecordingReader::readU32()
+{
+    uint32_t value;
+    readBytes(&value, sizeof(value));
+
+    return value;
+}
+
+uint32_t RecordingReader::readCount(uint64_t elementSize)
+{
+    const uint32_t count = readU32();
+    if (count * elementSize > remaining_)
+    {
+        throw std::runtime_error("corrupt recording: count exceeds the file size\n");
+    }
+
+    return count;
+}
+
+void RecordingReader::readPoints(std::vector<Point3f>& points)
+{
+    const uint32_t count = readCount(3u * sizeof(float32_t));
+    points.resize(count);
+    for (Point3f& p : points)
+    {
+        float32_t xyz[3];
+        readBytes(xyz, sizeof(xyz));
+        p.x = xyz[0];
+        p.y = xyz[1];
+        p.z = xyz[2];
+    }
+}
+
+void RecordingReader::readLanes(std::vector<LaneData>& lanes)
+{
+    lanes.resize(readCount(3u * sizeof(uint32_t)));
+    for (LaneData& lane : lanes)
+    {
+        lane.id = readU32();
+        readPoints(lane.leftDiv);
+        readPoints(lane.rightDiv);
+    }
+}
+
+void RecordingReader::readObstacles(std::vector<ObstacleData>& obstacles)
+{
+    obstacles.resize(readCount(4u * sizeof(uint32_t)));
+    for (ObstacleData& obs : obstacles)
+    {
+        obs.id = readU32();
+        const uint32_t shape = readU32();
+        if (shape > static_cast<uint32_t>(ObstacleShape::POLYGON))
+        {
+            throw std::runtime_error("corrupt recording: unknown obstacle shape\n");
+        }
+        obs.shape = static_cast<ObstacleShape>(shape);
+        readPoints(obs.boundaryPoints);
+        obs.holes.resize(readCount(sizeof(uint32_t)));
+        for (std::vector<Point3f>& hole : obs.holes)
+        {
+            readPoints(hole);
+        }
+    }
+}
+
+void RecordingReader::readFreespace(FreespaceData& freespace)
+{
+    freespace.data.resize(readCount(2u * sizeof(float32_t)));
+    for (std::pair<float32_t, float32_t>& beam : freespace.data)
+    {
+        float32_t values[2];
+        readBytes(values, sizeof(values));
+        beam.first = values[0];
+        beam.second = values[1];
+    }
+}
+
+void RecordingReader::readTrajectories(std::vector<TrajectoryData>& trajectories)
+{
+    trajectories.resize(readCount(2u * sizeof(uint32_t)));
+    for (TrajectoryData& trajectory : trajectories)
+    {
+        trajectory.id = readU32();
+        readObstacles(trajectory.footprints);
+    }
+}
+
+void RecordingReader::readBytes(void* data, uint64_t size)
+{
+    if (size > remaining_ || !file_.read(static_cast<char*>(data), static_cast<std::streamsize>(size)))
+    {
+        throw std::runtime_error("corrupt recording: truncated frame\n");
+    }
+    remaining_ -= size;
+}
+
+RecordingAnalyzer::RecordingAnalyzer(std::unique_ptr<ObjectInPathAnalyzerBase> analyzer, RecordingWriter& writer)
+    : analyzer_(std::move(analyzer))
+    , writer_(writer)
+{
+    if (!analyzer_)
+    {
+        throw std::runtime_error("no analyzer to record\n");
+    }
+}
+
+void RecordingAnalyzer::process(const std::vector<LaneView>& lanes,
+                                const std::vector<ObstacleView>& obstacles,
+                                std::vector<LaneAssignmentData>& result)
+{
+    writer_.writeLaneAssignment(lanes, obstacles);
+    analyzer_->process(lanes, obstacles, result);
+}
+
+void RecordingAnalyzer::process(const FreespaceBeams& freespace,
+                                const std::vector<ObstacleData>& obstacles,
+                                const std::vector<ObstacleData>& querys,
+                                std::vector<QueryCollisionData>& result)
+{
+    writer_.writeFreespaceQuery(freespace, obstacles, querys);
+    analyzer_->process(freespace, obstacles, querys, result);
+}
+
+void RecordingAnalyzer::process(const FreespaceBeams& freespace,
+                                const std::vector<ObstacleData>& obstacles,
+                                const std::vector<TrajectoryData>& trajectories,
+                                std::vector<TrajectoryCollisionData>& result)
+{
+    writer_.writeTrajectorySweep(freespace, obstacles, trajectories);
+    analyzer_->process(freespace, obstacles, trajectories, result);
+}
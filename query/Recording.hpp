@@ -0,0 +1,146 @@
+#ifndef RECORDING_HPP
+#define RECORDING_HPP
+
+#include <stdint.h>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ObjectInPathAnalyzerBase.hpp"
+
+// binary recordings of analyzer inputs, for replaying real traffic through every backend
+//
+// file layout, all integers uint32 and all coordinates float32 in host byte order (little-endian in practice):
+//   header:      "OIPR" version
+//   frame:       call, then by call
+//                  LANE_ASSIGNMENT:   lanes obstacles
+//                  FREESPACE_QUERY:   freespace obstacles querys
+//                  TRAJECTORY_SWEEP:  freespace obstacles trajectories
+//   lanes:       count, per lane: id points(leftDiv) points(rightDiv)
+//   obstacles:   count, per obstacle: id shape points(boundaryPoints) holeCount points(hole)...
+//   trajectories: count, per trajectory: id obstacles(footprints)
+//   freespace:   count, per beam: angle range
+//   points:      count, per point: x y z
+
+// which process() call a frame was recorded from
+enum class RecordedCall : uint32_t
+{
+    LANE_ASSIGNMENT = 0u,
+    FREESPACE_QUERY = 1u,
+    TRAJECTORY_SWEEP = 2u
+};
+
+// inputs of one process() call, only the members used by "call" are set
+struct RecordedFrame
+{
+    RecordedCall call{RecordedCall::LANE_ASSIGNMENT};
+    std::vector<LaneData> lanes{};
+    std::vector<ObstacleData> obstacles{};
+    FreespaceData freespace{};
+    std::vector<ObstacleData> querys{};
+    std::vector<TrajectoryData> trajectories{};
+};
+
+// appends frames to a recording file. Not thread-safe: one writer per analyzer
+class RecordingWriter
+{
+public:
+    // truncates "path". Throws if it cannot be opened
+    explicit RecordingWriter(const std::string& path);
+
+    // throws if the file cannot be written
+    void write(const RecordedFrame& frame);
+
+    // same, without copying the inputs into a RecordedFrame
+    void writeLaneAssignment(const std::vector<LaneData>& lanes, const std::vector<ObstacleData>& obstacles);
+    void writeLaneAssignment(const std::vector<LaneView>& lanes, const std::vector<ObstacleView>& obstacles);
+    void writeFreespaceQuery(const FreespaceBeams& freespace,
+                             const std::vector<ObstacleData>& obstacles,
+                             const std::vector<ObstacleData>& querys);
+    void writeTrajectorySweep(const FreespaceBeams& freespace,
+                              const std::vector<ObstacleData>& obstacles,
+                              const std::vector<TrajectoryData>& trajectories);
+
+    // frames written so far
+    size_t getFrameCount() const {return frameCount_;};
+
+private:
+    std::ofstream file_;
+    size_t frameCount_{0u};
+
+    void writeU32(uint32_t value);
+    void writePoints(const PointArray& points);
+    void writeLane(const LaneView& lane);
+    void writeObstacle(const ObstacleView& obs);
+    void writeObstacles(const std::vector<ObstacleData>& obstacles);
+    void writeFreespace(const FreespaceBeams& freespace);
+    void writeTrajectories(const std::vector<TrajectoryData>& trajectories);
+
+    // flush and throw if any write of the frame failed
+    void endFrame();
+
+}; // class RecordingWriter
+
+// reads the frames of a recording file in order
+class RecordingReader
+{
+public:
+    // throws if "path" cannot be opened or is not a recording
+    explicit RecordingReader(const std::string& path);
+
+    // read the next frame into "frame", reusing its storage. Returns false at the end of the file
+    // throws if the file is truncated or corrupt
+    bool read(RecordedFrame& frame);
+
+    // read every remaining frame
+    std::vector<RecordedFrame> readAll();
+
+private:
+    std::ifstream file_;
+    uint64_t remaining_{0u};    // bytes left in the file, bounds the counts of a corrupt file
+
+    uint32_t readU32();
+    // element count of "elementSize" bytes or more each
+    uint32_t readCount(uint64_t elementSize);
+    void readPoints(std::vector<Point3f>& points);
+    void readLanes(std::vector<LaneData>& lanes);
+    void readObstacles(std::vector<ObstacleData>& obstacles);
+    void readFreespace(FreespaceData& freespace);
+    void readTrajectories(std::vector<TrajectoryData>& trajectories);
+    void readBytes(void* data, uint64_t size);
+
+}; // class RecordingReader
+
+// recorder hook: forwards every call to "analyzer" after writing its inputs to "writer"
+// the writer must outlive the RecordingAnalyzer. The raster config is the one of the wrapped analyzer
+class RecordingAnalyzer : public ObjectInPathAnalyzerBase
+{
+public:
+    RecordingAnalyzer(std::unique_ptr<ObjectInPathAnalyzerBase> analyzer, RecordingWriter& writer);
+
+    ObjectInPathAnalyzerBase& getAnalyzer() {return *analyzer_;};
+
+    using ObjectInPathAnalyzerBase::process;
+
+    void process(const std::vector<LaneView>& lanes,
+                 const std::vector<ObstacleView>& obstacles,
+                 std::vector<LaneAssignmentData>& result) override;
+
+    void process(const FreespaceBeams& freespace,
+                 const std::vector<ObstacleData>& obstacles,
+                 const std::vector<ObstacleData>& querys,
+                 std::vector<QueryCollisionData>& result) override;
+
+    void process(const FreespaceBeams& freespace,
+                 const std::vector<ObstacleData>& obstacles,
+                 const std::vector<TrajectoryData>& trajectories,
+                 std::vector<TrajectoryCollisionData>& result) override;
+
+private:
+    std::unique_ptr<ObjectInPathAnalyzerBase> analyzer_;
+    RecordingWriter& writer_;
+
+}; // class RecordingAnalyzer
+
+#endif // RECORDING_HPP
@@ -0,0 +1,207 @@
+#include "SceneGenerator.hpp"
+#include <algorithm> // std::min std::max
+#include <cmath> // std::sin std::cos std::atan std::atan2 std::sqrt
+#include <random>
+
+namespace
+{
+
+constexpr float32_t LANE_WIDTH = 3.5f;
+constexpr float32_t REGION_HALF_SIZE = 50.0f;   // of the default RasterConfig
+constexpr float32_t FRAME_PERIOD = 0.1f;
+constexpr float32_t PI = 3.14159265f;
+
+// lateral offset of the lanes at "x", the same bend for all of them
+float32_t laneBend(float32_t x)
+{
+    return 2.0f * std::sin(x * 0.03f);
+}
+
+struct Vehicle
+{
+    float32_t x;
+    float32_t y;            // lane centre offset, or position off the lanes
+    float32_t heading;      // off the lanes only
+    float32_t speed;        // m/s
+    float32_t halfLength;
+    float32_t halfWidth;
+    bool onLane;
+};
+
+ObstacleData makeBox(float32_t cx, float32_t cy, float32_t heading, float32_t halfLength, float32_t halfWidth, uint32_t id)
+{
+    const float32_t c = std::cos(heading);
+    const float32_t s = std::sin(heading);
+    auto corner = [&](float32_t u, float32_t v) {
+        return Point3f{cx + c * u - s * v, cy + s * u + c * v, 0.0f};
+    };
+
+    // QUAD layout: 0-1-2 and 1-2-3
+    ObstacleData obs{};
+    obs.id = id;
+    obs.boundaryPoints = {corner(-halfLength, -halfWidth), corner(-halfLength, halfWidth),
+                          corner(halfLength, -halfWidth), corner(halfLength, halfWidth)};
+
+    return obs;
+}
+
+std::vector<LaneData> makeLanes(uint32_t laneCount)
+{
+    std::vector<LaneData> lanes(laneCount);
+    const float32_t firstRight = -0.5f * LANE_WIDTH * laneCount;
+    for (uint32_t j = 0u; j < laneCount; ++j)
+    {
+        lanes[j].id = j;
+        for (float32_t x = -REGION_HALF_SIZE; x <= REGION_HALF_SIZE; x += 5.0f)
+        {
+            const float32_t right = firstRight + j * LANE_WIDTH + laneBend(x);
+            lanes[j].leftDiv.push_back(Point3f{x, right + LANE_WIDTH, 0.0f});
+            lanes[j].rightDiv.push_back(Point3f{x, right, 0.0f});
+        }
+    }
+
+    return lanes;
+}
+
+std::vector<Vehicle> makeVehicles(const SceneConfig& config, std::mt19937& rng)
+{
+    std::uniform_real_distribution<float32_t> unit(0.0f, 1.0f);
+    std::vector<Vehicle> vehicles(config.obstacleCount);
+    for (Vehicle& v : vehicles)
+    {
+        v.onLane = config.laneCount > 0u && unit(rng) < 0.8f;
+        v.x = REGION_HALF_SIZE * (2.0f * unit(rng) - 1.0f);
+        v.halfLength = 1.5f + 1.5f * unit(rng);
+        v.halfWidth = 0.8f + 0.4f * unit(rng);
+        if (v.onLane)
+        {
+            const uint32_t lane = std::min(config.laneCount - 1u, static_cast<uint32_t>(unit(rng) * config.laneCount));
+            v.y = (lane + 0.5f - 0.5f * config.laneCount) * LANE_WIDTH + 0.4f * (unit(rng) - 0.5f);
+            v.speed = 5.0f + 25.0f * unit(rng);
+            v.heading = 0.0f;
+        }
+        else
+        {
+            v.y = REGION_HALF_SIZE * (2.0f * unit(rng) - 1.0f);
+            v.speed = unit(rng) < 0.5f ? 0.0f : 2.0f + 8.0f * unit(rng);
+            v.heading = 2.0f * PI * unit(rng);
+        }
+    }
+
+    return vehicles;
+}
+
+// move every vehicle by one frame, wrapping around the region
+void moveVehicles(std::vector<Vehicle>& vehicles)
+{
+    auto wrap = [](float32_t value) {
+        if (value > REGION_HALF_SIZE)
+        {
+            return value - 2.0f * REGION_HALF_SIZE;
+        }
+        if (value < -REGION_HALF_SIZE)
+        {
+            return value + 2.0f * REGION_HALF_SIZE;
+        }
+        return value;
+    };
+    for (Vehicle& v : vehicles)
+    {
+        if (v.onLane)
+        {
+            v.x = wrap(v.x + v.speed * FRAME_PERIOD);
+        }
+        else
+        {
+            v.x = wrap(v.x + v.speed * FRAME_PERIOD * std::cos(v.heading));
+            v.y = wrap(v.y + v.speed * FRAME_PERIOD * std::sin(v.heading));
+        }
+    }
+}
+
+void makeObstacles(const std::vector<Vehicle>& vehicles, std::vector<ObstacleData>& obstacles)
+{
+    obstacles.clear();
+    for (size_t i = 0u; i < vehicles.size(); ++i)
+    {
+        const Vehicle& v = vehicles[i];
+        if (v.onLane)
+        {
+            // follow the bend of the lane
+            const float32_t heading = std::atan(0.06f * std::cos(v.x * 0.03f));
+            obstacles.push_back(makeBox(v.x, v.y + laneBend(v.x), heading, v.halfLength, v.halfWidth, static_cast<uint32_t>(i)));
+        }
+        else
+        {
+            obstacles.push_back(makeBox(v.x, v.y, v.heading, v.halfLength, v.halfWidth, static_cast<uint32_t>(i)));
+        }
+    }
+}
+
+} // namespace
+
+std::vector<RecordedFrame> generateLaneScene(const SceneConfig& config)
+{
+    std::mt19937 rng(config.seed);
+    std::vector<Vehicle> vehicles = makeVehicles(config, rng);
+
+    std::vector<RecordedFrame> frames(config.frameCount);
+    for (RecordedFrame& frame : frames)
+    {
+        frame.call = RecordedCall::LANE_ASSIGNMENT;
+        frame.lanes = makeLanes(config.laneCount);
+        makeObstacles(vehicles, frame.obstacles);
+        moveVehicles(vehicles);
+    }
+
+    return frames;
+}
+
+std::vector<RecordedFrame> generateFreespaceScene(const SceneConfig& config)
+{
+    constexpr uint32_t BEAM_COUNT = 360u;
+    constexpr float32_t MAX_RANGE = 50.0f;
+
+    std::mt19937 rng(config.seed);
+    std::vector<Vehicle> vehicles = makeVehicles(config, rng);
+
+    // ego path: a left turn from the origin
+    std::vector<ObstacleData> querys{};
+    for (uint32_t k = 0u; k < config.queryCount; ++k)
+    {
+        const float32_t heading = 0.05f * k;
+        const float32_t radius = 20.0f;
+        querys.push_back(makeBox(radius * std::sin(heading), radius * (1.0f - std::cos(heading)), heading, 2.4f, 1.0f, k));
+    }
+
+    std::vector<RecordedFrame> frames(config.frameCount);
+    for (RecordedFrame& frame : frames)
+    {
+        frame.call = RecordedCall::FREESPACE_QUERY;
+        makeObstacles(vehicles, frame.obstacles);
+        frame.querys = querys;
+
+        // a beam stops at the first vehicle centre within its angular width
+        frame.freespace.data.resize(BEAM_COUNT);
+        for (uint32_t i = 0u; i < BEAM_COUNT; ++i)
+        {
+            frame.freespace.data[i] = std::make_pair(2.0f * PI * i / BEAM_COUNT - PI, MAX_RANGE);
+        }
+        for (const Vehicle& v : vehicles)
+        {
+            const float32_t y = v.onLane ? v.y + laneBend(v.x) : v.y;
+            const float32_t distance = std::sqrt(v.x * v.x + y * y);
+            if (distance < 1.0f)
+            {
+                continue;
+            }
+            const float32_t angle = std::atan2(y, v.x);
+            const uint32_t beam = static_cast<uint32_t>((angle + PI) / (2.0f * PI) * BEAM_COUNT) % BEAM_COUNT;
+            frame.freespace.data[beam].second = std::min(frame.freespace.data[beam].second,
+                                                          std::max(0.5f, distance - v.halfWidth));
+        }
+        moveVehicles(vehicles);
+    }
+
+    return frames;
+}
@@ -0,0 +1,24 @@
+#ifndef SCENE_GENERATOR_HPP
+#define SCENE_GENERATOR_HPP
+
+#include "Recording.hpp"
+
+// synthetic traffic for the benchmark, deterministic for a given config
+struct SceneConfig
+{
+    uint32_t laneCount{3u};         // adjacent lanes of 3.5 m, 1 to 16 fit the default region
+    uint32_t obstacleCount{10u};
+    uint32_t queryCount{16u};       // freespace scenes only, ego footprints along a path
+    uint32_t frameCount{100u};      // at 10 Hz
+    uint32_t seed{0u};
+};
+
+// gently curved lanes which stay the same in every frame, and vehicles driving along them
+// most vehicles are on the lanes, the others are parked or crossing anywhere in the region
+std::vector<RecordedFrame> generateLaneScene(const SceneConfig& config);
+
+// 360 beams whose ranges stop at the nearest obstacle, the obstacles moving as in generateLaneScene(),
+// and a fixed path of ego footprints
+std::vector<RecordedFrame> generateFreespaceScene(const SceneConfig& config);
+
+#endif // SCENE_GENERATOR_HPP
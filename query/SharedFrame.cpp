@@ -0,0 +1,448 @@
+#include "SharedFrame.hpp"
+#include <cstring> // std::memcpy
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+
+static_assert(sizeof(SharedRingHeader) == 64u, "the slots start on a cache line");
+static_assert(sizeof(SharedSlotHeader) == 64u, "the frames start on a cache line");
+
+inline uint64_t alignOffset(uint64_t offset)
+{
+    return (offset + 7u) & ~uint64_t(7u);
+}
+
+// layout of a frame of the given sizes, offsets of "header" set, returns the frame size
+uint64_t layoutFrame(SharedFrameHeader& header)
+{
+    header.laneOffset = alignOffset(sizeof(SharedFrameHeader));
+    header.obstacleOffset = alignOffset(header.laneOffset + uint64_t(header.laneCount) * sizeof(SharedLaneEntry));
+    header.holeOffset = alignOffset(header.obstacleOffset + uint64_t(header.obstacleCount) * sizeof(SharedObstacleEntry));
+    header.xOffset = alignOffset(header.holeOffset + uint64_t(header.holeCount) * sizeof(SharedHoleEntry));
+    header.yOffset = alignOffset(header.xOffset + uint64_t(header.pointCount) * sizeof(float32_t));
+    header.zOffset = alignOffset(header.yOffset + uint64_t(header.pointCount) * sizeof(float32_t));
+
+    return header.zOffset + uint64_t(header.pointCount) * sizeof(float32_t);
+}
+
+// counts of a frame of "lanes" and "obstacles", throws if they do not fit the format
+SharedFrameHeader countFrame(const std::vector<LaneData>& lanes, const std::vector<ObstacleData>& obstacles)
+{
+    uint64_t holeCount = 0u;
+    uint64_t pointCount = 0u;
+    for (const LaneData& lane : lanes)
+    {
+        if (lane.leftDiv.size() != lane.rightDiv.size())
+        {
+            throw std::runtime_error("left and right divider sizes do not match.\n");
+        }
+        pointCount += 2u * lane.leftDiv.size();
+    }
+    for (const ObstacleData& obs : obstacles)
+    {
+        pointCount += obs.boundaryPoints.size();
+        holeCount += obs.holes.size();
+        for (const std::vector<Point3f>& hole : obs.holes)
+        {
+            pointCount += hole.size();
+        }
+    }
+
+    const uint64_t maxCount = std::numeric_limits<uint32_t>::max();
+    if (lanes.size() > maxCount || obstacles.size() > maxCount || holeCount > maxCount || pointCount > maxCount)
+    {
+        throw std::runtime_error("shared frame has more than 2^32 - 1 elements\n");
+    }
+
+    SharedFrameHeader header{};
+    header.laneCount = static_cast<uint32_t>(lanes.size());
+    header.obstacleCount = static_cast<uint32_t>(obstacles.size());
+    header.holeCount = static_cast<uint32_t>(holeCount);
+    header.pointCount = static_cast<uint32_t>(pointCount);
+    layoutFrame(header);
+
+    return header;
+}
+
+// copies points into the SoA arrays of a frame
+class PointWriter
+{
+public:
+    PointWriter(uint8_t* frame, const SharedFrameHeader& header)
+        : x_(reinterpret_cast<float32_t*>(frame + header.xOffset))
+        , y_(reinterpret_cast<float32_t*>(frame + header.yOffset))
+        , z_(reinterpret_cast<float32_t*>(frame + header.zOffset))
+    {
+    };
+
+    // returns the index of the first point
+    uint32_t write(const std::vector<Point3f>& points)
+    {
+        const uint32_t begin = count_;
+        for (const Point3f& p : points)
+        {
+            x_[count_] = p.x;
+            y_[count_] = p.y;
+            z_[count_] = p.z;
+            ++count_;
+        }
+        return begin;
+    };
+
+private:
+    float32_t* x_;
+    float32_t* y_;
+    float32_t* z_;
+    uint32_t count_{0u};
+};
+
+} // namespace
+
+/**** writer ****/
+
+SharedFrameWriter::SharedFrameWriter(const std::string& name, uint32_t slotCount, uint64_t slotSize)
+    : name_(name)
+{
+    slotSize = (slotSize + 63u) & ~uint64_t(63u);
+    if (slotCount == 0u || slotSize < sizeof(SharedSlotHeader) + sizeof(SharedFrameHeader))
+    {
+        throw std::runtime_error("shared frame ring " + name + " needs at least one slot of one frame header\n");
+    }
+    size_ = sizeof(SharedRingHeader) + slotCount * slotSize;
+
+    fd_ = shm_open(name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0600);
+    if (fd_ < 0)
+    {
+        throw std::runtime_error("cannot create shared memory " + name + "\n");
+    }
+    void* memory = MAP_FAILED;
+    if (ftruncate(fd_, static_cast<off_t>(size_)) == 0)
+    {
+        memory = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    }
+    if (memory == MAP_FAILED)
+    {
+        close(fd_);
+        shm_unlink(name.c_str());
+        throw std::runtime_error("cannot map shared memory " + name + "\n");
+    }
+    memory_ = static_cast<uint8_t*>(memory);
+
+    // the object is zero-filled, only the atomics need to be constructed
+    ring_ = reinterpret_cast<SharedRingHeader*>(memory_);
+    for (uint32_t i = 0u; i < slotCount; ++i)
+    {
+        new (memory_ + sizeof(SharedRingHeader) + i * slotSize) SharedSlotHeader{};
+    }
+    new (&ring_->writeCount) std::atomic<uint64_t>(0u);
+    ring_->slotCount = slotCount;
+    ring_->slotSize = slotSize;
+    ring_->version = SHARED_FRAME_VERSION;
+    std::atomic_thread_fence(std::memory_order_release);
+    ring_->magic = SHARED_FRAME_MAGIC;
+}
+
+SharedFrameWriter::~SharedFrameWriter()
+{
+    munmap(memory_, size_);
+    close(fd_);
+    shm_unlink(name_.c_str());
+}
+
+uint64_t SharedFrameWriter::getFrameSize(const std::vector<LaneData>& lanes, const std::vector<ObstacleData>& obstacles)
+{
+    SharedFrameHeader header = countFrame(lanes, obstacles);
+    return layoutFrame(header);
+}
+
+uint64_t SharedFrameWriter::write(const std::vector<LaneData>& lanes, const std::vector<ObstacleData>& obstacles)
+{
+    SharedFrameHeader header = countFrame(lanes, obstacles);
+    if (layoutFrame(header) > ring_->slotSize - sizeof(SharedSlotHeader))
+    {
+        throw std::runtime_error("frame does not fit into a slot of shared frame ring " + name_ + "\n");
+    }
+
+    const uint64_t frameId = ring_->writeCount.load(std::memory_order_relaxed);
+    uint8_t* slotMemory = memory_ + sizeof(SharedRingHeader) + (frameId % ring_->slotCount) * ring_->slotSize;
+    SharedSlotHeader* slot = reinterpret_cast<SharedSlotHeader*>(slotMemory);
+    uint8_t* frame = slotMemory + sizeof(SharedSlotHeader);
+
+    // odd sequence: readers of the previous frame of the slot see it is being overwritten
+    const uint64_t sequence = slot->sequence.load(std::memory_order_relaxed);
+    slot->sequence.store(sequence + 1u, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    header.frameId = frameId;
+    std::memcpy(frame, &header, sizeof(header));
+
+    PointWriter points(frame, header);
+    SharedLaneEntry* laneEntries = reinterpret_cast<SharedLaneEntry*>(frame + header.laneOffset);
+    for (size_t j = 0u; j < lanes.size(); ++j)
+    {
+        SharedLaneEntry& entry = laneEntries[j];
+        entry.id = lanes[j].id;
+        entry.pointCount = static_cast<uint32_t>(lanes[j].leftDiv.size());
+        entry.leftBegin = points.write(lanes[j].leftDiv);
+        entry.rightBegin = points.write(lanes[j].rightDiv);
+    }
+
+    SharedObstacleEntry* obstacleEntries = reinterpret_cast<SharedObstacleEntry*>(frame + header.obstacleOffset);
+    SharedHoleEntry* holeEntries = reinterpret_cast<SharedHoleEntry*>(frame + header.holeOffset);
+    uint32_t holeCount = 0u;
+    for (size_t i = 0u; i < obstacles.size(); ++i)
+    {
+        const ObstacleData& obs = obstacles[i];
+        SharedObstacleEntry& entry = obstacleEntries[i];
+        entry.id = obs.id;
+        entry.shape = static_cast<uint32_t>(obs.shape);
+        entry.boundaryCount = static_cast<uint32_t>(obs.boundaryPoints.size());
+        entry.boundaryBegin = points.write(obs.boundaryPoints);
+        entry.holeBegin = holeCount;
+        entry.holeCount = static_cast<uint32_t>(obs.holes.size());
+        for (const std::vector<Point3f>& hole : obs.holes)
+        {
+            holeEntries[holeCount].pointCount = static_cast<uint32_t>(hole.size());
+            holeEntries[holeCount].pointBegin = points.write(hole);
+            ++holeCount;
+        }
+    }
+
+    // publish
+    slot->sequence.store(sequence + 2u, std::memory_order_release);
+    ring_->writeCount.store(frameId + 1u, std::memory_order_release);
+
+    return frameId;
+}
+
+/**** reader ****/
+
+SharedFrameReader::SharedFrameReader(const std::string& name)
+{
+    fd_ = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd_ < 0)
+    {
+        throw std::runtime_error("cannot open shared memory " + name + "\n");
+    }
+    struct stat info;
+    if (fstat(fd_, &info) != 0 || static_cast<uint64_t>(info.st_size) < sizeof(SharedRingHeader))
+    {
+        close(fd_);
+        throw std::runtime_error(name + " is not a shared frame ring\n");
+    }
+    size_ = static_cast<uint64_t>(info.st_size);
+
+    void* memory = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+    if (memory == MAP_FAILED)
+    {
+        close(fd_);
+        throw std::runtime_error("cannot map shared memory " + name + "\n");
+    }
+    memory_ = static_cast<const uint8_t*>(memory);
+    ring_ = reinterpret_cast<const SharedRingHeader*>(memory_);
+
+    const uint64_t slotSpace = size_ - sizeof(SharedRingHeader);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const char* error = nullptr;
+    if (ring_->magic != SHARED_FRAME_MAGIC)
+    {
+        error = " is not a shared frame ring\n";
+    }
+    else if (ring_->version != SHARED_FRAME_VERSION)
+    {
+        error = ": unsupported version of shared frame ring\n";
+    }
+    else if (ring_->slotCount == 0u || ring_->slotSize % 64u != 0u ||
+             ring_->slotSize < sizeof(SharedSlotHeader) + sizeof(SharedFrameHeader) ||
+             ring_->slotSize > slotSpace / ring_->slotCount)
+    {
+        error = ": corrupt shared frame ring header\n";
+    }
+    if (error != nullptr)
+    {
+        munmap(const_cast<uint8_t*>(memory_), size_);
+        close(fd_);
+        throw std::runtime_error(name + error);
+    }
+}
+
+SharedFrameReader::~SharedFrameReader()
+{
+    munmap(const_cast<uint8_t*>(memory_), size_);
+    close(fd_);
+}
+
+bool SharedFrameReader::acquire()
+{
+    const uint64_t writeCount = ring_->writeCount.load(std::memory_order_acquire);
+    if (writeCount == readCount_)
+    {
+        return false;
+    }
+
+    const uint8_t* slotMemory = memory_ + sizeof(SharedRingHeader) + ((writeCount - 1u) % ring_->slotCount) * ring_->slotSize;
+    const SharedSlotHeader* slot = reinterpret_cast<const SharedSlotHeader*>(slotMemory);
+    const uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+
+    // the views are rebuilt below, the previous frame is released whatever happens
+    slot_ = nullptr;
+    lanes_.clear();
+    obstacles_.clear();
+    holes_.clear();
+    if (sequence % 2u != 0u)
+    {
+        return false;   // already being overwritten
+    }
+
+    // a frame which does not match its slot is corrupt, unless the producer was overwriting it meanwhile
+    auto overwritten = [&]() {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot->sequence.load(std::memory_order_relaxed) != sequence;
+    };
+    auto check = [&](bool valid) {
+        if (!valid && !overwritten())
+        {
+            throw std::runtime_error("corrupt shared frame\n");
+        }
+        return valid;
+    };
+
+    const uint8_t* frame = slotMemory + sizeof(SharedSlotHeader);
+    const uint64_t frameSize = ring_->slotSize - sizeof(SharedSlotHeader);
+    SharedFrameHeader header;
+    std::memcpy(&header, frame, sizeof(header));
+
+    // counts are 32 bit, so none of the products below overflows
+    auto inFrame = [frameSize](uint64_t offset, uint64_t count, uint64_t elementSize) {
+        return offset % 4u == 0u && offset <= frameSize && count * elementSize <= frameSize - offset;
+    };
+    if (!check(inFrame(header.laneOffset, header.laneCount, sizeof(SharedLaneEntry)) &&
+               inFrame(header.obstacleOffset, header.obstacleCount, sizeof(SharedObstacleEntry)) &&
+               inFrame(header.holeOffset, header.holeCount, sizeof(SharedHoleEntry)) &&
+               inFrame(header.xOffset, header.pointCount, sizeof(float32_t)) &&
+               inFrame(header.yOffset, header.pointCount, sizeof(float32_t)) &&
+               inFrame(header.zOffset, header.pointCount, sizeof(float32_t))))
+    {
+        return false;
+    }
+
+    const float32_t* x = reinterpret_cast<const float32_t*>(frame + header.xOffset);
+    const float32_t* y = reinterpret_cast<const float32_t*>(frame + header.yOffset);
+    const float32_t* z = reinterpret_cast<const float32_t*>(frame + header.zOffset);
+    auto makeArray = [&](uint32_t begin, uint32_t count) {
+        PointArray points{};
+        points.x = x + begin;
+        points.y = y + begin;
+        points.z = z + begin;
+        points.count = count;
+        return points;
+    };
+    auto inPoints = [&header](uint32_t begin, uint32_t count) {
+        return uint64_t(begin) + count <= header.pointCount;
+    };
+
+    // holes first, the obstacle views point into holes_
+    for (uint32_t h = 0u; h < header.holeCount; ++h)
+    {
+        SharedHoleEntry entry;
+        std::memcpy(&entry, frame + header.holeOffset + h * sizeof(SharedHoleEntry), sizeof(entry));
+        if (!check(inPoints(entry.pointBegin, entry.pointCount)))
+        {
+            return false;
+        }
+        holes_.push_back(makeArray(entry.pointBegin, entry.pointCount));
+    }
+
+    for (uint32_t j = 0u; j < header.laneCount; ++j)
+    {
+        SharedLaneEntry entry;
+        std::memcpy(&entry, frame + header.laneOffset + j * sizeof(SharedLaneEntry), sizeof(entry));
+        if (!check(inPoints(entry.leftBegin, entry.pointCount) && inPoints(entry.rightBegin, entry.pointCount)))
+        {
+            return false;
+        }
+        LaneView lane{};
+        lane.id = entry.id;
+        lane.leftDiv = makeArray(entry.leftBegin, entry.pointCount);
+        lane.rightDiv = makeArray(entry.rightBegin, entry.pointCount);
+        lanes_.push_back(lane);
+    }
+
+    for (uint32_t i = 0u; i < header.obstacleCount; ++i)
+    {
+        SharedObstacleEntry entry;
+        std::memcpy(&entry, frame + header.obstacleOffset + i * sizeof(SharedObstacleEntry), sizeof(entry));
+        if (!check(inPoints(entry.boundaryBegin, entry.boundaryCount) &&
+                   uint64_t(entry.holeBegin) + entry.holeCount <= header.holeCount &&
+                   entry.shape <= static_cast<uint32_t>(ObstacleShape::POLYGON)))
+        {
+            return false;
+        }
+        ObstacleView obs{};
+        obs.id = entry.id;
+        obs.shape = static_cast<ObstacleShape>(entry.shape);
+        obs.boundaryPoints = makeArray(entry.boundaryBegin, entry.boundaryCount);
+        obs.holeCount = entry.holeCount;
+        obs.holeArrays = holes_.data() + entry.holeBegin;
+        obstacles_.push_back(obs);
+    }
+
+    if (overwritten())
+    {
+        lanes_.clear();
+        obstacles_.clear();
+        holes_.clear();
+        return false;
+    }
+
+    droppedFrameCount_ += writeCount - readCount_ - 1u;
+    readCount_ = writeCount;
+    frameId_ = header.frameId;
+    slot_ = slot;
+    sequence_ = sequence;
+
+    return true;
+}
+
+bool SharedFrameReader::isValid() const
+{
+    if (slot_ == nullptr)
+    {
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot_->sequence.load(std::memory_order_relaxed) == sequence_;
+}
+
+bool processLatestFrame(SharedFrameReader& reader,
+                        ObjectInPathAnalyzerBase& analyzer,
+                        std::vector<LaneAssignmentData>& result)
+{
+    if (!reader.acquire())
+    {
+        return false;
+    }
+
+    try
+    {
+        analyzer.process(reader.getLanes(), reader.getObstacles(), result);
+    }
+    catch (...)
+    {
+        // points torn by the producer can make the triangulation throw
+        if (reader.isValid())
+        {
+            throw;
+        }
+        return false;
+    }
+
+    return reader.isValid();
+}
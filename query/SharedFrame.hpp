@@ -0,0 +1,169 @@
+#ifndef SHARED_FRAME_HPP
+#define SHARED_FRAME_HPP
+
+// lane assignment frames published by a producer process into a POSIX shared memory ring,
+// and read in place by the analyzer process through the views of InputView.hpp: no parse and no copy of
+// the points, only one small view struct per lane, obstacle and hole is built per frame.
+//
+// Layout of the shared memory object: a SharedRingHeader, then slotCount slots of slotSize bytes.
+// A slot is a SharedSlotHeader followed by a frame:
+//     SharedFrameHeader
+//     SharedLaneEntry     [laneCount]
+//     SharedObstacleEntry [obstacleCount]
+//     SharedHoleEntry     [holeCount]
+//     float32_t x         [pointCount]
+//     float32_t y         [pointCount]
+//     float32_t z         [pointCount]
+// Offsets are in bytes from the start of the frame, point indices index the x, y and z arrays.
+// Every field has a fixed size and the native byte order: producer and analyzer run on the same host.
+//
+// Synchronization: the sequence of a slot is odd while the producer writes it and even once the frame
+// is published, then the ring writeCount is incremented. The reader takes the latest published frame and
+// checks the sequence again after using it (isValid()), a frame overwritten meanwhile has to be dropped.
+// With the default 4 slots this only happens if the analyzer falls 3 frames behind the producer
+
+#include "InputView.hpp"
+#include "ObjectInPathAnalyzerBase.hpp"
+#include <atomic>
+#include <string>
+
+constexpr uint32_t SHARED_FRAME_MAGIC = 0x4F495046u;    // "FPIO" in memory
+constexpr uint32_t SHARED_FRAME_VERSION = 1u;
+
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t), "shared counters are plain 64 bit words");
+
+struct SharedRingHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t reserved;
+    uint64_t slotSize;                  // in bytes, a multiple of 64
+    std::atomic<uint64_t> writeCount;   // frames published so far, the latest one is in slot (writeCount - 1) % slotCount
+    uint8_t padding[32];
+};
+
+struct SharedSlotHeader
+{
+    std::atomic<uint64_t> sequence;     // odd while the slot is written
+    uint8_t padding[56];
+};
+
+struct SharedFrameHeader
+{
+    uint64_t frameId;                   // writeCount of the producer before the frame
+    uint32_t laneCount;
+    uint32_t obstacleCount;
+    uint32_t holeCount;
+    uint32_t pointCount;
+    uint64_t laneOffset;
+    uint64_t obstacleOffset;
+    uint64_t holeOffset;
+    uint64_t xOffset;
+    uint64_t yOffset;
+    uint64_t zOffset;
+};
+
+struct SharedLaneEntry
+{
+    uint32_t id;
+    uint32_t pointCount;                // of each divider
+    uint32_t leftBegin;
+    uint32_t rightBegin;
+};
+
+struct SharedObstacleEntry
+{
+    uint32_t id;
+    uint32_t shape;                     // ObstacleShape
+    uint32_t boundaryBegin;
+    uint32_t boundaryCount;
+    uint32_t holeBegin;                 // in the hole table
+    uint32_t holeCount;
+};
+
+struct SharedHoleEntry
+{
+    uint32_t pointBegin;
+    uint32_t pointCount;
+};
+
+// creates the shared memory object "name" (e.g. "/oipa_frames") and publishes frames into it
+// the object is unlinked by the destructor. Not thread-safe: one producer per ring
+class SharedFrameWriter
+{
+public:
+    // throws if the object cannot be created
+    SharedFrameWriter(const std::string& name, uint32_t slotCount = 4u, uint64_t slotSize = 1u << 20);
+    ~SharedFrameWriter();
+
+    SharedFrameWriter(const SharedFrameWriter&) = delete;
+    SharedFrameWriter& operator=(const SharedFrameWriter&) = delete;
+
+    // publish a frame, returns its id. Throws if it does not fit into a slot, nothing is published then
+    uint64_t write(const std::vector<LaneData>& lanes, const std::vector<ObstacleData>& obstacles);
+
+    // bytes of the frame of "lanes" and "obstacles"
+    static uint64_t getFrameSize(const std::vector<LaneData>& lanes, const std::vector<ObstacleData>& obstacles);
+
+private:
+    std::string name_;
+    int fd_{-1};
+    uint8_t* memory_{nullptr};
+    uint64_t size_{0u};
+    SharedRingHeader* ring_{nullptr};
+
+}; // class SharedFrameWriter
+
+// maps the shared memory object of a SharedFrameWriter read-only and views its latest frame
+class SharedFrameReader
+{
+public:
+    // throws if "name" cannot be opened or is not a frame ring
+    explicit SharedFrameReader(const std::string& name);
+    ~SharedFrameReader();
+
+    SharedFrameReader(const SharedFrameReader&) = delete;
+    SharedFrameReader& operator=(const SharedFrameReader&) = delete;
+
+    // view the latest published frame. Returns false if there is no frame newer than the last acquired one,
+    // or if it was being overwritten. Throws if the frame is inconsistent with its slot
+    bool acquire();
+
+    // views of the acquired frame, pointing into the shared memory
+    const std::vector<LaneView>& getLanes() const {return lanes_;};
+    const std::vector<ObstacleView>& getObstacles() const {return obstacles_;};
+    uint64_t getFrameId() const {return frameId_;};
+
+    // published frames which were never acquired
+    uint64_t getDroppedFrameCount() const {return droppedFrameCount_;};
+
+    // true while the acquired frame has not been overwritten, i.e. everything read from its views so far is
+    // consistent. Check it after using the views
+    bool isValid() const;
+
+private:
+    int fd_{-1};
+    const uint8_t* memory_{nullptr};
+    uint64_t size_{0u};
+    const SharedRingHeader* ring_{nullptr};
+
+    const SharedSlotHeader* slot_{nullptr};  // of the acquired frame
+    uint64_t sequence_{0u};                 // of slot_ when the frame was acquired
+    uint64_t readCount_{0u};                // writeCount of the acquired frame
+    uint64_t frameId_{0u};
+    uint64_t droppedFrameCount_{0u};
+
+    std::vector<LaneView> lanes_{};
+    std::vector<ObstacleView> obstacles_{};
+    std::vector<PointArray> holes_{};
+
+}; // class SharedFrameReader
+
+// lane assignment of the latest frame of "reader" into "result"
+// returns false, with "result" undefined, if there was no new frame or if it was overwritten during the call
+bool processLatestFrame(SharedFrameReader& reader,
+                        ObjectInPathAnalyzerBase& analyzer,
+                        std::vector<LaneAssignmentData>& result);
+
+#endif // SHARED_FRAME_HPP
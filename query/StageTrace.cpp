@@ -0,0 +1,116 @@
+#include "StageTrace.hpp"
+#include <algorithm> // std::min
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+const char* getStageName(Stage stage)
+{
+    switch (stage)
+    {
+    case Stage::TRIANGULATION:
+        return "triangulation";
+    case Stage::UPLOAD:
+        return "upload";
+    case Stage::LANE_RASTER:
+        return "lane_raster";
+    case Stage::OBSTACLE_RASTER:
+        return "obstacle_raster";
+    case Stage::READBACK:
+        return "readback";
+    }
+    return "unknown";
+}
+
+StageTrace::StageTrace(size_t capacity)
+{
+    size_t size = 1u;
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+    slots_.reset(new Slot[size]);
+    mask_ = size - 1u;
+}
+
+void StageTrace::push(const StageEvent& event)
+{
+    const uint64_t index = writeCount_.load(std::memory_order_relaxed);
+    Slot& slot = slots_[index & mask_];
+
+    slot.sequence.store(2u * index + 1u, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.event = event;
+    slot.sequence.store(2u * index + 2u, std::memory_order_release);
+
+    writeCount_.store(index + 1u, std::memory_order_release);
+}
+
+void StageTrace::snapshot(std::vector<StageEvent>& events) const
+{
+    events.clear();
+    const uint64_t end = writeCount_.load(std::memory_order_acquire);
+    const uint64_t begin = end > getCapacity() ? end - getCapacity() : 0u;
+    for (uint64_t index = begin; index < end; ++index)
+    {
+        const Slot& slot = slots_[index & mask_];
+        const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != 2u * index + 2u)
+        {
+            continue;
+        }
+        const StageEvent event = slot.event;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == sequence)
+        {
+            events.push_back(event);
+        }
+    }
+}
+
+void StageTrace::writeChromeTrace(const std::string& path, const std::string& processName) const
+{
+    std::vector<StageEvent> events{};
+    snapshot(events);
+
+    std::ofstream file(path.c_str());
+    if (!file)
+    {
+        throw std::runtime_error("cannot open trace file " + path + "\n");
+    }
+
+    // timestamps in microseconds from the oldest event
+    uint64_t origin = events.empty() ? 0u : events[0].begin;
+    for (const StageEvent& event : events)
+    {
+        origin = std::min(origin, event.begin);
+    }
+
+    file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    file << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 0, \"args\": {\"name\": \"" << processName << "\"}},\n";
+    file << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": 0, \"args\": {\"name\": \"cpu\"}},\n";
+    file << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": 1, \"args\": {\"name\": \"gpu\"}}";
+    file << std::fixed << std::setprecision(3);
+    for (const StageEvent& event : events)
+    {
+        file << ",\n{\"name\": \"" << getStageName(event.stage) << "\", \"cat\": \"" << (event.gpu ? "gpu" : "cpu")
+             << "\", \"ph\": \"X\", \"pid\": 0, \"tid\": " << (event.gpu ? 1 : 0)
+             << ", \"ts\": " << (event.begin - origin) / 1000.0
+             << ", \"dur\": " << event.duration / 1000.0
+             << ", \"args\": {\"frame\": " << event.frame << "}}";
+    }
+    file << "\n]}\n";
+
+    file.flush();
+    if (!file)
+    {
+        throw std::runtime_error("cannot write trace file " + path + "\n");
+    }
+}
+
+uint64_t StageTrace::now()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
@@ -0,0 +1,76 @@
+#ifndef STAGE_TRACE_HPP
+#define STAGE_TRACE_HPP
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+// stages of a lane assignment call, see ObjectInPathAnalyzer::setProfiling()
+enum class Stage : uint32_t
+{
+    TRIANGULATION = 0u,     // CPU geometry: obstacle triangulation, lane cache and coverage culling
+    UPLOAD = 1u,            // vertex data handed to the driver
+    LANE_RASTER = 2u,       // lanes into the stencil buffer or the lane mask
+    OBSTACLE_RASTER = 3u,   // obstacle draws and their occlusion queries
+    READBACK = 4u           // waiting for and downloading the query results
+};
+
+constexpr size_t STAGE_COUNT = 5u;
+
+const char* getStageName(Stage stage);
+
+struct StageEvent
+{
+    uint64_t frame{0u};
+    Stage stage{Stage::TRIANGULATION};
+    bool gpu{false};        // measured with a GL_TIME_ELAPSED timer query instead of the steady clock
+    uint64_t begin{0u};     // ns on the steady clock, GPU events begin when their first draw was issued
+    uint64_t duration{0u};  // ns
+};
+
+// fixed-size ring of the latest stage events, the oldest ones are overwritten
+// one thread pushes (the thread of the analyzer), any thread can take a snapshot meanwhile: every slot has a
+// sequence, odd while the slot is written, and a snapshot leaves out the events overwritten while it copied them
+class StageTrace
+{
+public:
+    // "capacity" is rounded up to a power of two
+    explicit StageTrace(size_t capacity = 1u << 14);
+
+    StageTrace(const StageTrace&) = delete;
+    StageTrace& operator=(const StageTrace&) = delete;
+
+    // never blocks and never allocates
+    void push(const StageEvent& event);
+
+    // events still in the ring, oldest first
+    void snapshot(std::vector<StageEvent>& events) const;
+
+    // events pushed so far, including the overwritten ones
+    uint64_t getEventCount() const {return writeCount_.load(std::memory_order_acquire);};
+
+    size_t getCapacity() const {return mask_ + 1u;};
+
+    // write a snapshot as Chrome trace JSON (chrome://tracing, Perfetto): one complete event per stage event,
+    // CPU and GPU stages on two threads of process "processName". Throws if the file cannot be written
+    void writeChromeTrace(const std::string& path, const std::string& processName = "analyzer") const;
+
+    // ns on the steady clock
+    static uint64_t now();
+
+private:
+    struct Slot
+    {
+        std::atomic<uint64_t> sequence{0u};     // 2 * index + 2 once event #index is written, odd while writing
+        StageEvent event{};
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_;
+    std::atomic<uint64_t> writeCount_{0u};
+
+}; // class StageTrace
+
+#endif // STAGE_TRACE_HPP
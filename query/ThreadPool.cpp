@@ -0,0 +1,91 @@
+#include "ThreadPool.hpp"
+#include <algorithm> // std::max
+
+ThreadPool::ThreadPool(uint32_t threadCount)
+{
+    if (threadCount == 0u)
+    {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (uint32_t i = 1u; i < threadCount; ++i)
+    {
+        workers_.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wakeCondition_.notify_all();
+
+    for (std::thread& worker : workers_)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPool::run(size_t count, Task task, void* context)
+{
+    if (workers_.empty() || count <= 1u)
+    {
+        for (size_t i = 0u; i < count; ++i)
+        {
+            task(context, i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = task;
+        context_ = context;
+        count_ = count;
+        nextIndex_.store(0u);
+        busyWorkers_ = static_cast<uint32_t>(workers_.size());
+        ++generation_;
+    }
+    wakeCondition_.notify_all();
+
+    work();
+
+    // the job's context lives on the caller's stack: wait until no worker can touch it anymore
+    std::unique_lock<std::mutex> lock(mutex_);
+    doneCondition_.wait(lock, [this] { return busyWorkers_ == 0u; });
+}
+
+void ThreadPool::workerLoop()
+{
+    uint64_t seenGeneration = 0u;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wakeCondition_.wait(lock, [&] { return stop_ || generation_ != seenGeneration; });
+            if (stop_)
+            {
+                return;
+            }
+            seenGeneration = generation_;
+        }
+
+        work();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --busyWorkers_;
+        }
+        doneCondition_.notify_one();
+    }
+}
+
+void ThreadPool::work()
+{
+    for (size_t i = nextIndex_.fetch_add(1u); i < count_; i = nextIndex_.fetch_add(1u))
+    {
+        task_(context_, i);
+    }
+}
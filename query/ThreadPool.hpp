@@ -0,0 +1,61 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// fixed set of worker threads for data-parallel loops
+// the workers are created once, so a parallelFor() per frame neither spawns threads nor allocates
+class ThreadPool
+{
+public:
+    // threadCount includes the calling thread. 0 means one thread per hardware core
+    explicit ThreadPool(uint32_t threadCount = 0u);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    uint32_t getThreadCount() const {return static_cast<uint32_t>(workers_.size()) + 1u;};
+
+    // call fn(i) for every i in [0, count) and return once all calls returned
+    // the calling thread takes part in the work. fn must not throw
+    template<typename F>
+    void parallelFor(size_t count, F& fn)
+    {
+        run(count, [](void* context, size_t i) { (*static_cast<F*>(context))(i); }, &fn);
+    }
+
+private:
+    using Task = void (*)(void*, size_t);
+
+    void run(size_t count, Task task, void* context);
+
+    void workerLoop();
+
+    // take indices of the current job until none is left
+    void work();
+
+    std::vector<std::thread> workers_{};
+
+    std::mutex mutex_{};
+    std::condition_variable wakeCondition_{};
+    std::condition_variable doneCondition_{};
+
+    // current job, protected by mutex_ except for nextIndex_
+    Task task_{nullptr};
+    void* context_{nullptr};
+    size_t count_{0u};
+    std::atomic<size_t> nextIndex_{0u};
+    uint64_t generation_{0u};   // incremented for every job
+    uint32_t busyWorkers_{0u};  // workers still inside the current job
+    bool stop_{false};
+
+}; // class ThreadPool
+
+#endif // THREAD_POOL_HPP
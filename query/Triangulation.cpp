@@ -0,0 +1,165 @@
+#include "Triangulation.hpp"
+#include <poly2tri/poly2tri.h>
+#include <stdexcept> // std::runtime_error
+
+namespace
+{
+
+inline float32_t* writeVertex(float32_t* out, const Point3f& p)
+{
+    out[0] = p.x;
+    out[1] = p.y;
+    out[2] = p.z;
+    return out + 3;
+}
+
+// "ring" without repeated consecutive points, closing point and collinear points, as poly2tri expects
+void cleanRing(const PointArray& ring, std::vector<p2t::Point>& out)
+{
+    out.clear();
+    for (size_t i = 0u; i < ring.size(); ++i)
+    {
+        const Point3f p = ring[i];
+        if (out.empty() || out.back().x != p.x || out.back().y != p.y)
+        {
+            out.emplace_back(p.x, p.y);
+        }
+    }
+    while (out.size() > 1u && out.back().x == out.front().x && out.back().y == out.front().y)
+    {
+        out.pop_back();
+    }
+
+    // a removal can make the neighbours collinear, so repeat until nothing changes
+    bool removed = true;
+    while (removed && out.size() >= 3u)
+    {
+        removed = false;
+        for (size_t i = 0u; i < out.size() && out.size() >= 3u;)
+        {
+            const p2t::Point& a = out[(i + out.size() - 1u) % out.size()];
+            const p2t::Point& b = out[i];
+            const p2t::Point& c = out[(i + 1u) % out.size()];
+            if ((b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y) == 0.0)
+            {
+                out.erase(out.begin() + i);
+                removed = true;
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+    if (out.size() < 3u)
+    {
+        out.clear();
+    }
+}
+
+} // namespace
+
+VertexSpan trivialObstacleTriangulation(const ObstacleView& obs, FrameArena& arena)
+{
+    if (obs.boundaryPoints.size() < 4u)
+    {
+        throw std::runtime_error("obstacle has less than 4 boundary points.\n");
+    }
+
+    VertexSpan ret = arena.allocate(6u * 3u);
+    float32_t* out = ret.data;
+    for (size_t i = 0u; i < 3u; ++i)
+    {
+        out = writeVertex(out, obs.boundaryPoints[i]);
+    }
+    for (size_t i = 1u; i < 4u; ++i)
+    {
+        out = writeVertex(out, obs.boundaryPoints[i]);
+    }
+
+    return ret;
+}
+
+VertexSpan polygonObstacleTriangulation(const ObstacleView& obs, FrameArena& arena)
+{
+    // poly2tri keeps pointers to the points: every ring gets its own vector, none is resized afterwards
+    std::vector<std::vector<p2t::Point>> rings(1u + obs.holeCount);
+    cleanRing(obs.boundaryPoints, rings[0]);
+    if (rings[0].empty())
+    {
+        return arena.allocate(0u);
+    }
+    for (size_t h = 0u; h < obs.holeCount; ++h)
+    {
+        cleanRing(obs.getHole(h), rings[1u + h]);
+    }
+
+    std::vector<p2t::Point*> polyline{};
+    auto toPolyline = [&polyline](std::vector<p2t::Point>& ring) {
+        polyline.clear();
+        for (p2t::Point& p : ring)
+        {
+            polyline.push_back(&p);
+        }
+        return polyline;
+    };
+
+    p2t::CDT cdt(toPolyline(rings[0]));
+    for (size_t r = 1u; r < rings.size(); ++r)
+    {
+        if (!rings[r].empty())
+        {
+            cdt.AddHole(toPolyline(rings[r]));
+        }
+    }
+    cdt.Triangulate();
+
+    const std::vector<p2t::Triangle*>& triangles = cdt.GetTriangles();
+    const float32_t z = obs.boundaryPoints[0].z;
+    VertexSpan ret = arena.allocate(triangles.size() * 3u * 3u);
+    float32_t* out = ret.data;
+    for (p2t::Triangle* tri : triangles)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            const p2t::Point* p = tri->GetPoint(k);
+            out = writeVertex(out, Point3f{static_cast<float32_t>(p->x), static_cast<float32_t>(p->y), z});
+        }
+    }
+
+    return ret;
+}
+
+VertexSpan obstacleTriangulation(const ObstacleView& obs, FrameArena& arena)
+{
+    if (obs.shape == ObstacleShape::POLYGON)
+    {
+        return polygonObstacleTriangulation(obs, arena);
+    }
+    return trivialObstacleTriangulation(obs, arena);
+}
+
+VertexSpan trivialLaneTriangulation(const LaneView& lane, FrameArena& arena)
+{
+    // check lane data matches the expectation
+    if (lane.leftDiv.size() != lane.rightDiv.size())
+    {
+        throw std::runtime_error("left and right divider sizes do not match.\n");
+    }
+
+    const size_t segmentCount = lane.leftDiv.empty() ? 0u : lane.leftDiv.size() - 1u;
+    VertexSpan ret = arena.allocate(segmentCount * 6u * 3u);
+    float32_t* out = ret.data;
+    for (size_t i = 0u; i < segmentCount; ++i)
+    {
+        out = writeVertex(out, lane.leftDiv[i]);
+        out = writeVertex(out, lane.leftDiv[i + 1]);
+        out = writeVertex(out, lane.rightDiv[i]);
+
+        out = writeVertex(out, lane.leftDiv[i + 1]);
+        out = writeVertex(out, lane.rightDiv[i]);
+        out = writeVertex(out, lane.rightDiv[i + 1]);
+    }
+
+    return ret;
+}
@@ -0,0 +1,28 @@
+#ifndef TRIANGULATION_HPP
+#define TRIANGULATION_HPP
+
+// triangulation of the input data into vertex data (x, y, z per vertex)
+// shared by every ObjectInPathAnalyzer backend. The input is read through views (InputView.hpp), the vertex data is written into "arena" and stays
+// valid until its next reset(), so a frame triangulates without touching the heap
+
+#include "InputView.hpp"
+#include "FrameArena.hpp"
+
+// output GL_TRIANGLES layout, triangles 0-1-2 and 1-2-3 of a QUAD obstacle
+VertexSpan trivialObstacleTriangulation(const ObstacleView& obs, FrameArena& arena);
+
+// output GL_TRIANGLES layout, constrained Delaunay triangulation (poly2tri) of a POLYGON obstacle
+// repeated and collinear outline points are removed first. Outlines with less than 3 points
+// left yield no triangle. Every vertex gets the z of the first boundary point
+VertexSpan polygonObstacleTriangulation(const ObstacleView& obs, FrameArena& arena);
+
+// output GL_TRIANGLES layout, dispatches on obs.shape
+VertexSpan obstacleTriangulation(const ObstacleView& obs, FrameArena& arena);
+
+// output GL_TRIANGLES layout, 2 triangles per divider segment
+// assume left and right dividers have the same size
+VertexSpan trivialLaneTriangulation(const LaneView& lane, FrameArena& arena);
+
+// the freespace fan is built by FreespaceBuilder, which keeps the beam directions across calls
+
+#endif // TRIANGULATION_HPP
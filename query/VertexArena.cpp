@@ -0,0 +1,186 @@
+#include "VertexArena.hpp"
+#include <string.h> // memcpy
+#include <stdexcept>
+
+namespace
+{
+
+constexpr size_t FLOATS_PER_VERTEX = 3u;
+
+// timeout of a single fence wait, the wait is repeated until the fence is signaled
+constexpr GLuint64 FENCE_TIMEOUT_NS = 1000000u;
+
+} // namespace
+
+VertexArena::VertexArena(size_t regionVertexCount, size_t regionCount)
+    : regionVertexCount_(regionVertexCount > 0u ? regionVertexCount : 1u)
+    , regionCount_(regionCount > 0u ? regionCount : 1u)
+{
+    persistent_ = GLEW_ARB_buffer_storage;
+    fences_.resize(regionCount_, 0);
+    staging_.reserve(regionVertexCount_ * FLOATS_PER_VERTEX);
+
+    glGenVertexArrays(1, &vao_);
+    createBuffer();
+}
+
+VertexArena::~VertexArena()
+{
+    releaseBuffer();
+    glDeleteVertexArrays(1, &vao_);
+}
+
+void VertexArena::bind() const
+{
+    glBindVertexArray(vao_);
+}
+
+void VertexArena::beginFrame()
+{
+    region_ = (region_ + 1u) % regionCount_;
+    waitFence(region_);
+    staging_.clear();
+}
+
+DrawRange VertexArena::append(const GLfloat* vertexData, size_t floatCount)
+{
+    DrawRange range{};
+    range.first = static_cast<GLint>(staging_.size() / FLOATS_PER_VERTEX);
+    range.count = static_cast<GLsizei>(floatCount / FLOATS_PER_VERTEX);
+    staging_.insert(staging_.end(), vertexData, vertexData + range.count * FLOATS_PER_VERTEX);
+
+    return range;
+}
+
+void VertexArena::upload()
+{
+    const size_t vertexCount = staging_.size() / FLOATS_PER_VERTEX;
+    if (vertexCount > regionVertexCount_)
+    {
+        // a new buffer object: frames in flight keep reading the old one until the driver releases it
+        while (regionVertexCount_ < vertexCount)
+        {
+            regionVertexCount_ *= 2u;
+        }
+        releaseBuffer();
+        createBuffer();
+        region_ = 0u;
+    }
+
+    const size_t regionOffset = region_ * regionVertexCount_ * FLOATS_PER_VERTEX;
+    const size_t bytes = staging_.size() * sizeof(GLfloat);
+    if (bytes > 0u)
+    {
+        if (persistent_)
+        {
+            // coherent mapping, visible to commands issued after the copy
+            memcpy(mapped_ + regionOffset, staging_.data(), bytes);
+        }
+        else
+        {
+            // the fence of beginFrame() already guarantees the region is unused
+            glBindBuffer(GL_ARRAY_BUFFER, buffer_);
+            void* dst = glMapBufferRange(GL_ARRAY_BUFFER, regionOffset * sizeof(GLfloat), bytes,
+                                         GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+            if (dst == nullptr)
+            {
+                throw std::runtime_error("failed to map the vertex arena\n");
+            }
+            memcpy(dst, staging_.data(), bytes);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+        }
+    }
+
+    // the ranges returned by append() are relative to the region start
+    glBindVertexArray(vao_);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer_);
+    glVertexAttribPointer(
+        0,                  // attribute 0, must match the layout in the shader.
+        3,                  // size
+        GL_FLOAT,           // type
+        GL_FALSE,           // normalized?
+        0,                  // stride
+        reinterpret_cast<void*>(regionOffset * sizeof(GLfloat))  // array buffer offset
+    );
+}
+
+void VertexArena::endFrame()
+{
+    if (fences_[region_] != 0)
+    {
+        glDeleteSync(fences_[region_]);
+    }
+    fences_[region_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void VertexArena::createBuffer()
+{
+    const size_t bytes = regionCount_ * regionVertexCount_ * FLOATS_PER_VERTEX * sizeof(GLfloat);
+
+    glGenBuffers(1, &buffer_);
+    glBindVertexArray(vao_);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer_);
+    if (persistent_)
+    {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, bytes, NULL, flags);
+        mapped_ = static_cast<GLfloat*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes, flags));
+        if (mapped_ == nullptr)
+        {
+            throw std::runtime_error("failed to map the vertex arena\n");
+        }
+    }
+    else
+    {
+        glBufferData(GL_ARRAY_BUFFER, bytes, NULL, GL_STREAM_DRAW);
+    }
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+}
+
+void VertexArena::releaseBuffer()
+{
+    for (GLsync& fence : fences_)
+    {
+        if (fence != 0)
+        {
+            glDeleteSync(fence);
+            fence = 0;
+        }
+    }
+
+    if (buffer_ != 0u)
+    {
+        if (mapped_ != nullptr)
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, buffer_);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+            mapped_ = nullptr;
+        }
+        glDeleteBuffers(1, &buffer_);
+        buffer_ = 0u;
+    }
+}
+
+void VertexArena::waitFence(size_t region)
+{
+    GLsync& fence = fences_[region];
+    if (fence == 0)
+    {
+        return;
+    }
+
+    GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT_NS);
+    while (status == GL_TIMEOUT_EXPIRED)
+    {
+        status = glClientWaitSync(fence, 0, FENCE_TIMEOUT_NS);
+    }
+    if (status == GL_WAIT_FAILED)
+    {
+        throw std::runtime_error("failed to wait for the vertex arena\n");
+    }
+
+    glDeleteSync(fence);
+    fence = 0;
+}
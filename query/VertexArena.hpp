@@ -0,0 +1,74 @@
+#ifndef VERTEX_ARENA_HPP
+#define VERTEX_ARENA_HPP
+
+// Include standard headers
+#include <stdint.h>
+#include <stddef.h>
+#include <GL/glew.h>
+#include <vector>
+
+// vertices [first, first + count) of the current frame
+struct DrawRange
+{
+    GLint first{0};
+    GLsizei count{0};
+};
+
+// persistent vertex storage for the analyzers, replacing per-draw buffer uploads
+// one vertex buffer and one VAO (attribute 0: vec3 position) live as long as the arena.
+// The buffer is split into a ring of regions, one per frame, each guarded by a fence, so that a frame
+// never overwrites vertices which the GPU may still read for an earlier frame.
+// A frame is used as follows:
+//   beginFrame(); append() every geometry; upload(); draw the ranges returned by append(); endFrame();
+class VertexArena
+{
+public:
+    // regionVertexCount is the initial capacity of a frame, the arena grows when a frame needs more
+    explicit VertexArena(size_t regionVertexCount = 4096u, size_t regionCount = 3u);
+    ~VertexArena();
+
+    VertexArena(const VertexArena&) = delete;
+    VertexArena& operator=(const VertexArena&) = delete;
+
+    // bind the VAO
+    void bind() const;
+
+    // start a new frame in the next region, waits if the GPU still reads that region
+    void beginFrame();
+
+    // stage vertex data (3 floats per vertex) for the current frame. Nothing is sent to the GPU yet
+    DrawRange append(const GLfloat* vertexData, size_t floatCount);
+    DrawRange append(const std::vector<GLfloat>& vertexData) {return append(vertexData.data(), vertexData.size());};
+
+    // copy every staged vertex to the current region with a single memcpy. Call before the first draw
+    void upload();
+
+    // the GPU is done with the frame once every command issued so far is complete
+    void endFrame();
+
+    // true if the buffer is mapped once for its lifetime (ARB_buffer_storage)
+    bool isPersistent() const {return persistent_;};
+
+private:
+    GLuint vao_{0u};
+    GLuint buffer_{0u};
+    bool persistent_{false};
+    GLfloat* mapped_{nullptr};  // whole buffer, persistent mapping only
+
+    size_t regionVertexCount_;
+    size_t regionCount_;
+    size_t region_{0u};     // region of the current frame
+
+    std::vector<GLsync> fences_{};  // one per region, 0 if the region is free
+    std::vector<GLfloat> staging_{};
+
+    // (re)create the buffer with the current region size
+    void createBuffer();
+
+    void releaseBuffer();
+
+    void waitFence(size_t region);
+
+}; // class VertexArena
+
+#endif // VERTEX_ARENA_HPP
@@ -0,0 +1,482 @@
+// Include standard headers
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Include GLEW
+#include <GL/glew.h>
+
+#include <common/context.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "ObjectInPathAnalyzer.hpp"
+#include "CpuObjectInPathAnalyzer.hpp"
+#include "AnalyticObjectInPathAnalyzer.hpp"
+#include "CoherentAnalyzer.hpp"
+#include "Recording.hpp"
+#include "SceneGenerator.hpp"
+
+// replays recorded or generated frames through every backend and prints latency, throughput and
+// allocation statistics as JSON on stdout
+//
+// usage: query_benchmark [--replay file] [--record file] [--frames n] [--warmup n] [--no-gl] [--trace prefix]
+//                        [--output file]
+//   --replay   benchmark the frames of a recording instead of the generated scenes
+//   --record   write the generated scenes to a recording
+//   --frames   frames per generated scene (100)
+//   --warmup   frames processed before the timing starts, to fill the caches (1)
+//   --no-gl    skip the OpenGL backends, e.g. without any OpenGL driver
+//   --trace    profile the stages of the OpenGL backends and write their Chrome traces to <prefix><backend>.json
+//   --output   write the JSON report to a file instead of stdout, which the OpenGL backends share with their
+//              diagnostics
+//              the timer queries add some overhead to the latencies
+
+/**** allocation counting ****/
+// every allocation of the process goes through these, including those of the GL driver
+static std::atomic<uint64_t> allocationCount{0u};
+static std::atomic<uint64_t> allocatedBytes{0u};
+
+void* operator new(size_t size)
+{
+    allocationCount.fetch_add(1u, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    void* ptr = malloc(size == 0u ? 1u : size);
+    if (ptr == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+// the deletes are kept out of line: GCC would otherwise see free() on the result of the replaced operator new
+// and warn with -Wmismatched-new-delete
+#ifdef __GNUC__
+#define OUT_OF_LINE __attribute__((noinline))
+#else
+#define OUT_OF_LINE
+#endif
+
+OUT_OF_LINE void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+OUT_OF_LINE void operator delete[](void* ptr) noexcept
+{
+    free(ptr);
+}
+
+OUT_OF_LINE void operator delete(void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+OUT_OF_LINE void operator delete[](void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+namespace
+{
+
+struct Scene
+{
+    std::string name;
+    std::vector<RecordedFrame> frames;
+};
+
+// one backend under test, either a rasterizing one or the analytic one
+struct Backend
+{
+    std::string name;
+    ObjectInPathAnalyzerBase* analyzer;             // nullptr for the analytic backend
+    AnalyticObjectInPathAnalyzer* analytic;
+    CoherentAnalyzer* coherent{nullptr};           // same as analyzer for the coherent backend, for its reuse count
+
+    bool supports(RecordedCall call) const {return analyzer != nullptr || call == RecordedCall::LANE_ASSIGNMENT;};
+};
+
+struct Stats
+{
+    size_t frames{0u};
+    float64_t p50{0.0};     // ms
+    float64_t p99{0.0};
+    float64_t max{0.0};
+    float64_t framesPerSecond{0.0};
+    float64_t allocationsPerFrame{0.0};
+    float64_t bytesPerFrame{0.0};
+    float64_t checksum{0.0};    // sum of the result areas, changes if the results do
+    float64_t reusedPerFrame{-1.0};     // obstacles whose lane assignment was reused, coherent backend only
+};
+
+// result storage reused across frames, as a deployment would
+struct Results
+{
+    std::vector<LaneAssignmentData> lanes{};
+    std::vector<QueryCollisionData> querys{};
+    std::vector<TrajectoryCollisionData> trajectories{};
+};
+
+// process "frame" with "backend" and return the sum of the result areas
+float64_t processFrame(const Backend& backend, const RecordedFrame& frame, Results& results)
+{
+    float64_t checksum = 0.0;
+    switch (frame.call)
+    {
+    case RecordedCall::LANE_ASSIGNMENT:
+        if (backend.analyzer != nullptr)
+        {
+            backend.analyzer->process(frame.lanes, frame.obstacles, results.lanes);
+        }
+        else
+        {
+            backend.analytic->process(frame.lanes, frame.obstacles, results.lanes);
+        }
+        for (const LaneAssignmentData& elem : results.lanes)
+        {
+            checksum += elem.obstacleTotalArea;
+            for (float32_t area : elem.intersectionAreas)
+            {
+                checksum += area;
+            }
+        }
+        break;
+    case RecordedCall::FREESPACE_QUERY:
+        backend.analyzer->process(frame.freespace, frame.obstacles, frame.querys, results.querys);
+        for (const QueryCollisionData& elem : results.querys)
+        {
+            checksum += elem.collisionArea;
+        }
+        break;
+    case RecordedCall::TRAJECTORY_SWEEP:
+        backend.analyzer->process(frame.freespace, frame.obstacles, frame.trajectories, results.trajectories);
+        for (const TrajectoryCollisionData& elem : results.trajectories)
+        {
+            checksum += elem.collisionArea;
+        }
+        break;
+    }
+
+    return checksum;
+}
+
+Stats run(const Backend& backend, const std::vector<RecordedFrame>& frames, size_t warmupCount)
+{
+    Results results{};
+    Stats stats{};
+
+    size_t warmedUp = 0u;
+    for (size_t k = 0u; k < frames.size() && warmedUp < warmupCount; ++k)
+    {
+        if (backend.supports(frames[k].call))
+        {
+            processFrame(backend, frames[k], results);
+            ++warmedUp;
+        }
+    }
+
+    std::vector<float64_t> latencies{};
+    latencies.reserve(frames.size());
+    const uint64_t allocationsBefore = allocationCount.load();
+    const uint64_t bytesBefore = allocatedBytes.load();
+    float64_t total = 0.0;
+    size_t reusedCount = 0u;
+    size_t laneFrameCount = 0u;
+    for (const RecordedFrame& frame : frames)
+    {
+        if (!backend.supports(frame.call))
+        {
+            continue;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        stats.checksum += processFrame(backend, frame, results);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        if (backend.coherent != nullptr && frame.call == RecordedCall::LANE_ASSIGNMENT)
+        {
+            reusedCount += backend.coherent->getReusedCount();
+            ++laneFrameCount;
+        }
+
+        const float64_t ms = std::chrono::duration<float64_t, std::milli>(elapsed).count();
+        latencies.push_back(ms);
+        total += ms;
+    }
+    const uint64_t allocations = allocationCount.load() - allocationsBefore;
+    const uint64_t bytes = allocatedBytes.load() - bytesBefore;
+
+    stats.frames = latencies.size();
+    if (stats.frames == 0u)
+    {
+        return stats;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](float64_t p) {
+        return latencies[std::min(latencies.size() - 1u, static_cast<size_t>(p * latencies.size()))];
+    };
+    stats.p50 = percentile(0.5);
+    stats.p99 = percentile(0.99);
+    stats.max = latencies.back();
+    stats.framesPerSecond = total > 0.0 ? 1000.0 * stats.frames / total : 0.0;
+    stats.allocationsPerFrame = static_cast<float64_t>(allocations) / stats.frames;
+    stats.bytesPerFrame = static_cast<float64_t>(bytes) / stats.frames;
+    if (laneFrameCount > 0u)
+    {
+        stats.reusedPerFrame = static_cast<float64_t>(reusedCount) / laneFrameCount;
+    }
+
+    return stats;
+}
+
+std::vector<Scene> generateScenes(uint32_t frameCount)
+{
+    std::vector<Scene> scenes{};
+    for (uint32_t laneCount : {1u, 4u, 16u})
+    {
+        for (uint32_t obstacleCount : {10u, 100u, 1000u})
+        {
+            SceneConfig config{};
+            config.laneCount = laneCount;
+            config.obstacleCount = obstacleCount;
+            config.frameCount = frameCount;
+            config.seed = laneCount * 1000u + obstacleCount;
+            scenes.push_back(Scene{"lanes" + std::to_string(laneCount) + "_obstacles" + std::to_string(obstacleCount),
+                                   generateLaneScene(config)});
+        }
+    }
+    for (uint32_t obstacleCount : {10u, 100u, 1000u})
+    {
+        SceneConfig config{};
+        config.obstacleCount = obstacleCount;
+        config.frameCount = frameCount;
+        config.seed = obstacleCount;
+        scenes.push_back(Scene{"freespace_obstacles" + std::to_string(obstacleCount), generateFreespaceScene(config)});
+    }
+
+    return scenes;
+}
+
+// "text" as the contents of a JSON string
+std::string escapeJson(const std::string& text)
+{
+    std::string escaped{};
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            escaped.push_back('\\');
+        }
+        escaped.push_back(c);
+    }
+
+    return escaped;
+}
+
+void printStats(FILE* out, const std::string& backend, const Stats& stats, bool last)
+{
+    fprintf(out, "        {\"backend\": \"%s\", \"frames\": %zu, \"p50_ms\": %.4f, \"p99_ms\": %.4f, \"max_ms\": %.4f, "
+           "\"frames_per_s\": %.1f, \"allocations_per_frame\": %.2f, \"allocated_bytes_per_frame\": %.1f, "
+           "\"checksum\": %.3f",
+           backend.c_str(), stats.frames, stats.p50, stats.p99, stats.max, stats.framesPerSecond,
+           stats.allocationsPerFrame, stats.bytesPerFrame, stats.checksum);
+    if (stats.reusedPerFrame >= 0.0)
+    {
+        fprintf(out, ", \"reused_per_frame\": %.2f", stats.reusedPerFrame);
+    }
+    fprintf(out, "}%s\n", last ? "" : ",");
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::string replayPath{};
+    std::string recordPath{};
+    uint32_t frameCount = 100u;
+    size_t warmupCount = 1u;
+    bool useGl = true;
+    std::string tracePrefix{};
+    std::string outputPath{};
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--replay") == 0 && hasValue)
+        {
+            replayPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--record") == 0 && hasValue)
+        {
+            recordPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--frames") == 0 && hasValue)
+        {
+            frameCount = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        }
+        else if (strcmp(argv[i], "--warmup") == 0 && hasValue)
+        {
+            warmupCount = static_cast<size_t>(strtoul(argv[++i], nullptr, 10));
+        }
+        else if (strcmp(argv[i], "--no-gl") == 0)
+        {
+            useGl = false;
+        }
+        else if (strcmp(argv[i], "--trace") == 0 && hasValue)
+        {
+            tracePrefix = argv[++i];
+        }
+        else if (strcmp(argv[i], "--output") == 0 && hasValue)
+        {
+            outputPath = argv[++i];
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--replay file] [--record file] [--frames n] [--warmup n] [--no-gl] [--trace prefix] "
+                    "[--output file]\n", argv[0]);
+            return -1;
+        }
+    }
+
+    std::vector<Scene> scenes{};
+    try
+    {
+        if (!replayPath.empty())
+        {
+            RecordingReader reader(replayPath);
+            scenes.push_back(Scene{replayPath, reader.readAll()});
+        }
+        else
+        {
+            scenes = generateScenes(frameCount);
+        }
+
+        if (!recordPath.empty())
+        {
+            RecordingWriter writer(recordPath);
+            for (const Scene& scene : scenes)
+            {
+                for (const RecordedFrame& frame : scene.frames)
+                {
+                    writer.write(frame);
+                }
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        fprintf(stderr, "%s", e.what());
+        return -1;
+    }
+
+    // headless, the window is only a fallback
+    const bool hasContext = useGl && createContext(false, 64, 64, "Query benchmark");
+    if (useGl && !hasContext)
+    {
+        fprintf(stderr, "no OpenGL 3.3 context, the GL backends are skipped\n");
+    }
+
+    std::unique_ptr<ObjectInPathAnalyzer> glPerLane{};
+    std::unique_ptr<ObjectInPathAnalyzer> glBatched{};
+    std::unique_ptr<ObjectInPathAnalyzer> glLaneMask{};
+    if (hasContext)
+    {
+        glPerLane.reset(new ObjectInPathAnalyzer());
+        glBatched.reset(new ObjectInPathAnalyzer());
+        glBatched->setLaneAssignmentMode(LaneAssignmentMode::BATCHED);
+        glLaneMask.reset(new ObjectInPathAnalyzer());
+        glLaneMask->setLaneAssignmentMode(LaneAssignmentMode::LANE_MASK);
+
+        glPerLane->setProfiling(!tracePrefix.empty());
+        glBatched->setProfiling(!tracePrefix.empty());
+        glLaneMask->setProfiling(!tracePrefix.empty());
+    }
+    CpuObjectInPathAnalyzer cpu{};
+    AnalyticObjectInPathAnalyzer analytic{};
+    CoherentAnalyzer cpuCoherent(std::unique_ptr<ObjectInPathAnalyzerBase>(new CpuObjectInPathAnalyzer()));
+
+    std::vector<Backend> backends{};
+    if (hasContext)
+    {
+        backends.push_back(Backend{"gl_per_lane", glPerLane.get(), nullptr});
+        backends.push_back(Backend{"gl_batched", glBatched.get(), nullptr});
+        backends.push_back(Backend{"gl_lane_mask", glLaneMask.get(), nullptr});
+    }
+    backends.push_back(Backend{"cpu", &cpu, nullptr});
+    backends.push_back(Backend{"analytic", nullptr, &analytic});
+    backends.push_back(Backend{"cpu_coherent", &cpuCoherent, nullptr, &cpuCoherent});
+
+    FILE* out = stdout;
+    if (!outputPath.empty())
+    {
+        out = fopen(outputPath.c_str(), "w");
+        if (out == nullptr)
+        {
+            fprintf(stderr, "cannot open output file %s\n", outputPath.c_str());
+            return -1;
+        }
+    }
+
+    fprintf(out, "{\n  \"scenes\": [\n");
+    for (size_t s = 0u; s < scenes.size(); ++s)
+    {
+        fprintf(out, "    {\"name\": \"%s\", \"frames\": %zu, \"results\": [\n", escapeJson(scenes[s].name).c_str(), scenes[s].frames.size());
+
+        std::vector<std::pair<std::string, Stats>> results{};
+        for (const Backend& backend : backends)
+        {
+            Stats stats = run(backend, scenes[s].frames, warmupCount);
+            if (stats.frames > 0u)
+            {
+                results.emplace_back(backend.name, stats);
+            }
+        }
+        for (size_t k = 0u; k < results.size(); ++k)
+        {
+            printStats(out, results[k].first, results[k].second, k + 1u == results.size());
+        }
+
+        fprintf(out, "    ]}%s\n", s + 1u == scenes.size() ? "" : ",");
+    }
+    fprintf(out, "  ]\n}\n");
+    if (out != stdout && fclose(out) != 0)
+    {
+        fprintf(stderr, "cannot write output file %s\n", outputPath.c_str());
+        return -1;
+    }
+
+    if (hasContext && !tracePrefix.empty())
+    {
+        try
+        {
+            glPerLane->getStageTrace().writeChromeTrace(tracePrefix + "gl_per_lane.json", "gl_per_lane");
+            glBatched->getStageTrace().writeChromeTrace(tracePrefix + "gl_batched.json", "gl_batched");
+            glLaneMask->getStageTrace().writeChromeTrace(tracePrefix + "gl_lane_mask.json", "gl_lane_mask");
+        }
+        catch (const std::exception& e)
+        {
+            fprintf(stderr, "%s", e.what());
+        }
+    }
+
+    glPerLane.reset();
+    glBatched.reset();
+    glLaneMask.reset();
+    if (hasContext)
+    {
+        destroyContext();
+    }
+
+    return 0;
+}
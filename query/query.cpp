@@ -14,15 +14,20 @@ GLFWwindow* window;
 using namespace glm;
 
 #include <common/shader.hpp>
+#include <common/context.hpp>
 
 #include <iostream>
 #include <chrono>
 
 #include "ObjectInPathAnalyzer.hpp"
+#include "CpuObjectInPathAnalyzer.hpp"
+#include "AnalyticObjectInPathAnalyzer.hpp"
+#include "AnalyzerPool.hpp"
 
 constexpr uint32_t WIN_W = 800;
 constexpr uint32_t WIN_H = 800;
 
+// without rendering, the analyzer runs in a headless context which needs no display server
 constexpr bool render = true;
 
 constexpr bool DEBUG_PRINT_RESULTS = true;
@@ -42,50 +47,21 @@ constexpr bool DEBUG_PRINT_RESULTS = true;
 int main(void)
 {
     {
-        // Initialise GLFW
-        if (!glfwInit())
-        {
-            fprintf(stderr, "Failed to initialize GLFW\n");
-            getchar();
-            return -1;
-        }
-
-        glfwWindowHint(GLFW_SAMPLES, 4);
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE); // To make MacOS happy; should not be needed
-        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-        // Open a window and create its OpenGL context
-        if (!render)
-        {
-            std::cout << "hide window" << std::endl;
-            glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
-        }
-        window = glfwCreateWindow(WIN_W, WIN_H, "Query", NULL, NULL);
-
-        if (window == NULL)
+        // Open a window, or create a headless context, and initialize GLEW
+        if (!createContext(render, WIN_W, WIN_H, "Query"))
         {
             fprintf(stderr,
-                    "Failed to open GLFW window. If you have an Intel GPU, they are not 3.3 compatible. Try the 2.1 version of the tutorials.\n");
+                    "Failed to create an OpenGL 3.3 context. If you have an Intel GPU, they are not 3.3 compatible. Try the 2.1 version of the tutorials.\n");
             getchar();
-            glfwTerminate();
             return -1;
         }
-        glfwMakeContextCurrent(window);
+        window = getContextWindow();
 
-        // Initialize GLEW
-        glewExperimental = true; // Needed for core profile
-        if (glewInit() != GLEW_OK)
+        // Ensure we can capture the escape key being pressed below
+        if (window != NULL)
         {
-            fprintf(stderr, "Failed to initialize GLEW\n");
-            getchar();
-            glfwTerminate();
-            return -1;
+            glfwSetInputMode(window, GLFW_STICKY_KEYS, GL_TRUE);
         }
-
-        // Ensure we can capture the escape key being pressed below
-        glfwSetInputMode(window, GLFW_STICKY_KEYS, GL_TRUE);
     }
 
     LaneData lane0{}; // lane #0
@@ -132,6 +108,7 @@ int main(void)
     obs2.boundaryPoints.push_back(Point3f{.x = 15.0f, .y = 5.5f, .z = 0.0f});
 
     ObjectInPathAnalyzer oipa{};
+    oipa.setLaneAssignmentMode(LaneAssignmentMode::BATCHED);
     // oipa.process();
     for (size_t cnt = 0u; cnt < 100u; ++cnt)
     {
@@ -141,6 +118,60 @@ int main(void)
         );
     }
 
+    // same lane assignment without GL context
+    CpuObjectInPathAnalyzer cpuOipa{};
+    TIME_IT("process lane assignment on CPU",
+        cpuOipa.process(std::vector<LaneData>({lane0, lane1, lane2}),
+                        std::vector<ObstacleData>({obs0, obs1, obs2}))
+    );
+
+    // exact overlap areas, independent of the framebuffer resolution
+    AnalyticObjectInPathAnalyzer analyticOipa{};
+    TIME_IT("process lane assignment analytically",
+        analyticOipa.process(std::vector<LaneData>({lane0, lane1, lane2}),
+                             std::vector<ObstacleData>({obs0, obs1, obs2}))
+    );
+
+    // one request per sensor stream, processed concurrently by CPU analyzers on worker threads
+    // a GL worker would create and make current its own offscreen context in the factory
+    AnalyzerPool pool(4u, []() {
+        return std::unique_ptr<ObjectInPathAnalyzerBase>(new CpuObjectInPathAnalyzer(1u));
+    });
+    TIME_IT("pooled lane assignment of 6 streams",
+        std::vector<std::future<std::vector<LaneAssignmentData>>> streamResults{};
+        for (uint32_t stream = 0u; stream < 6u; ++stream)
+        {
+            streamResults.push_back(pool.process(stream,
+                                                 std::vector<LaneData>({lane0, lane1, lane2}),
+                                                 std::vector<ObstacleData>({obs0, obs1, obs2})));
+        }
+        for (auto& streamResult : streamResults)
+        {
+            streamResult.get();
+        }
+    );
+
+    // pipelined lane assignment: results arrive a few frames after submission
+    std::vector<LaneAssignmentData> result{};
+    FrameTicket ticket{0u};
+    size_t harvested{0u};
+    TIME_IT("pipelined lane assignment",
+        for (size_t cnt = 0u; cnt < 100u; ++cnt)
+        {
+            oipa.submit(std::vector<LaneData>({lane0, lane1, lane2}),
+                        std::vector<ObstacleData>({obs0, obs1, obs2}));
+            while (oipa.harvest(ticket, result))
+            {
+                ++harvested;
+            }
+        }
+        while (oipa.harvest(ticket, result, true))
+        {
+            ++harvested;
+        }
+    );
+    std::cout << "harvested " << harvested << " frames" << std::endl;
+
     // mock freespace
     FreespaceData fs{};
     for (uint32_t i = 0u; i < 181u; ++i)
@@ -173,7 +204,8 @@ int main(void)
     glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);   // set screen as the draw framebuffer
 
     // Check if the ESC key was pressed or the window was closed
-    while (glfwGetWindowAttrib(window, GLFW_VISIBLE) &&
+    while (window != NULL &&
+           glfwGetWindowAttrib(window, GLFW_VISIBLE) &&
            glfwGetKey(window, GLFW_KEY_ESCAPE) != GLFW_PRESS &&
            glfwWindowShouldClose(window) == 0)
     {
@@ -182,7 +214,7 @@ int main(void)
         glClear(GL_STENCIL_BUFFER_BIT);
         glClear(GL_DEPTH_BUFFER_BIT);
 
-        glBlitFramebuffer(0, 0, WIN_W, WIN_H,
+        glBlitFramebuffer(0, 0, oipa.getRasterView().width, oipa.getRasterView().height,
                           0, 0, WIN_W, WIN_H,
                           GL_COLOR_BUFFER_BIT, GL_LINEAR);
 
@@ -193,7 +225,7 @@ int main(void)
     }
 
     // Close OpenGL window and terminate GLFW
-    glfwTerminate();
+    destroyContext();
 
     return 0;
 }
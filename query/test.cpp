@@ -0,0 +1,73 @@
+// Include standard headers
+#include <stdio.h>
+
+#include <cmath>
+#include <vector>
+
+#include "AnalyticObjectInPathAnalyzer.hpp"
+#include "CpuObjectInPathAnalyzer.hpp"
+
+// checks of the backends which need no OpenGL context, run by ctest
+// every check prints what failed and returns false
+
+namespace
+{
+
+ObstacleData makeBox(float32_t minX, float32_t maxX, float32_t minY, float32_t maxY, uint32_t id)
+{
+    ObstacleData obstacle;
+    obstacle.boundaryPoints = {{minX, minY, 0.0f}, {maxX, minY, 0.0f}, {minX, maxY, 0.0f}, {maxX, maxY, 0.0f}};
+    obstacle.shape = ObstacleShape::QUAD;
+    obstacle.id = id;
+    return obstacle;
+}
+
+// the ratio of lane "laneId" in "elem", 0 if the obstacle is not on that lane
+float32_t coverageRatio(const LaneAssignmentData& elem, uint32_t laneId)
+{
+    for (size_t i = 0u; i < elem.laneIds.size(); ++i)
+    {
+        if (elem.laneIds[i] == laneId)
+        {
+            return elem.coverageRatios[i];
+        }
+    }
+    return 0.0f;
+}
+
+// a lane narrowing to a point, as at a lane merge, has a degenerate last triangle
+bool checkTaperingLane()
+{
+    LaneData lane;
+    lane.leftDiv = {{0.0f, 1.0f, 0.0f}, {10.0f, 0.0f, 0.0f}};
+    lane.rightDiv = {{0.0f, -1.0f, 0.0f}, {10.0f, 0.0f, 0.0f}};
+    lane.id = 7u;
+    const std::vector<LaneData> lanes{lane};
+    const std::vector<ObstacleData> obstacles{makeBox(1.0f, 3.0f, -0.2f, 0.2f, 1u)};
+
+    std::vector<LaneAssignmentData> analytic;
+    AnalyticObjectInPathAnalyzer().process(lanes, obstacles, analytic);
+    std::vector<LaneAssignmentData> cpu;
+    CpuObjectInPathAnalyzer(1u).process(lanes, obstacles, cpu);
+
+    const float32_t analyticRatio = coverageRatio(analytic[0], lane.id);
+    const float32_t cpuRatio = coverageRatio(cpu[0], lane.id);
+    if (std::abs(analyticRatio - 1.0f) > 1e-5f || std::abs(cpuRatio - 1.0f) > 1e-2f)
+    {
+        fprintf(stderr, "tapering lane: coverage ratio %f (analytic), %f (cpu), expected 1\n",
+                analyticRatio, cpuRatio);
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main()
+{
+    int failures = 0;
+    failures += checkTaperingLane() ? 0 : 1;
+
+    printf("%d check(s) failed\n", failures);
+    return failures == 0 ? 0 : 1;
+}